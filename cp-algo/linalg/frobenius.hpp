@@ -62,12 +62,13 @@ namespace cp_algo::linalg {
                 basis[i].normalize();
             }
             auto T = matrix(basis_init);
-            auto Tinv = matrix(basis);
-            std::ignore = Tinv.sort_classify(n);
+            auto B = matrix(basis);
+            std::ignore = B.sort_classify(n);
+            matrix Tinv(n);
             for(size_t i = 0; i < n; i++) {
                 Tinv[i] = vec_t(
-                    Tinv[i] | std::views::drop(n) | std::views::take(n)
-                ) * (base(1) / Tinv[i][i]);
+                    B[i] | std::views::drop(n) | std::views::take(n)
+                ) * (base(1) / B[i][i]);
             }
             return std::tuple{T, Tinv, charps};
         } else {
@@ -92,6 +93,67 @@ namespace cp_algo::linalg {
         return Tinv * S * T;
     }
 
+    // Characteristic polynomial of the Hessenberg form H of A, p_0 = 1 and
+    // p_{k+1} = (x - h_kk) p_k - sum_{i<k} h_ik h_{i+1,i} ... h_{k,k-1} p_i,
+    // the coefficients of p_k are kept in the rows of P
+    template<typename base>
+    auto charpoly(matrix<base> A) {
+        A.hessenberg();
+        size_t n = A.n();
+        matrix<base> P(n + 1);
+        P[0][0] = 1;
+        // Lazy sums of add_scaled only when they fit, like in matrix::apply
+        const bool lazy = impl::lazy_fits<base>();
+        auto add_scaled = [&](auto a, auto b, base scale) {
+            if(lazy) {
+                impl::add_scaled<base>(a, b, scale);
+            } else {
+                for(size_t j = 0; j < size(a); j++) {
+                    a[j] += scale * b[j];
+                }
+            }
+        };
+        for(size_t k = 0; k < n; k++) {
+            auto pk = P[k + 1];
+            std::ranges::copy(P[k] | std::views::take(k + 1), begin(pk) + 1);
+            add_scaled(pk.first(k + 1), P[k].first(k + 1), -A[k][k]);
+            base t = 1;
+            for(size_t i = k, calls = 1; i-- > 0; calls++) {
+                t *= A[i + 1][i];
+                if(t == base(0)) {
+                    break;
+                }
+                if(lazy && calls % 4 == 0) {
+                    impl::pseudonormalize<base>(pk);
+                }
+                add_scaled(pk.first(i + 1), P[i].first(i + 1), -A[i][k] * t);
+            }
+            impl::normalize<base>(pk);
+        }
+        return math::poly_t<base>(typename math::poly_t<base>::Vector(begin(P[n]), end(P[n])));
+    }
+
+    // x A^k for a row vector x: x^k is reduced modulo charp, which is
+    // the characteristic polynomial of A or any other polynomial that
+    // vanishes on A, and the remainder is evaluated at A applied to x
+    // by Horner's rule, so only deg(charp) products with vectors are needed
+    template<typename base>
+    auto apply_pow(matrix<base> const& A, typename matrix<base>::vec_t const& x, uint64_t k, math::poly_t<base> const& charp) {
+        auto r = math::poly_t<base>::xk(1).powmod(k, charp);
+        typename matrix<base>::vec_t res(size(x));
+        for(int i = r.deg(); i >= 0; i--) {
+            res = A.apply(res);
+            for(size_t j = 0; j < size(x); j++) {
+                res[j] += r[i] * x[j];
+            }
+        }
+        return res;
+    }
+    template<typename base>
+    auto apply_pow(matrix<base> const& A, typename matrix<base>::vec_t const& x, uint64_t k) {
+        return apply_pow(A, x, k, charpoly(A));
+    }
+
     template<typename base>
     auto frobenius_pow(matrix<base> const& A, uint64_t k) {
         return with_frobenius(A, [k](auto const& charp) {
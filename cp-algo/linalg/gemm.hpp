@@ -0,0 +1,203 @@
+#ifndef CP_ALGO_LINALG_GEMM_HPP
+#define CP_ALGO_LINALG_GEMM_HPP
+#include "../number_theory/modint.hpp"
+#include "../util/big_alloc.hpp"
+#include "../util/simd.hpp"
+#include "../util/parallel.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <span>
+namespace cp_algo::linalg {
+    namespace impl {
+        // C tiles of mr x nr are kept in mr * nr / 4 u64x4 registers,
+        // A and B are packed into kc x mc and kc x nc panels that fit in L2 and L3
+        constexpr size_t gemm_mr = 6, gemm_nr = 8;
+        constexpr size_t gemm_kc = 256, gemm_mc = 72, gemm_nc = 1024;
+
+        // Sums of products are reduced lazily: x = hi 2^32 + lo becomes
+        // hi (2^32 mod m) + lo, which is below gemm_bound(m) and is the same mod m
+        inline uint64_t gemm_bound(uint64_t m) {
+            return (uint64_t(-1) >> 32) * ((uint64_t(1) << 32) % m) + (uint64_t(-1) >> 32);
+        }
+        [[gnu::target("avx2")]] inline u64x4 gemm_reduce(u64x4 x, u64x4 c) {
+            return u64x4(_mm256_mul_epu32(__m256i(x >> 32), __m256i(c))) + low32(x);
+        }
+
+        // c[i][j] += sum a[k][i] b[k][j] for a full mr x nr tile,
+        // reducing after every `steps` products, so that nothing overflows
+        [[gnu::target("avx2")]] inline void gemm_micro(
+            size_t kc, size_t steps, uint64_t const* a, uint64_t const* b,
+            uint64_t* c, size_t ldc, u64x4 cr
+        ) {
+            constexpr size_t nv = gemm_nr / 4;
+            u64x4 acc[gemm_mr][nv];
+            for(size_t i = 0; i < gemm_mr; i++) {
+                for(size_t j = 0; j < nv; j++) {
+                    acc[i][j] = vector_cast<u64x4>(c[i * ldc + 4 * j]);
+                }
+            }
+            for(size_t k = 0; k < kc; ) {
+                for(size_t r = std::min(kc, k + steps); k < r; k++) {
+                    u64x4 bk[nv];
+                    for(size_t j = 0; j < nv; j++) {
+                        bk[j] = vector_cast<u64x4 const>(b[k * gemm_nr + 4 * j]);
+                    }
+                    for(size_t i = 0; i < gemm_mr; i++) {
+                        auto ai = __m256i() + (long long)a[k * gemm_mr + i];
+                        for(size_t j = 0; j < nv; j++) {
+                            acc[i][j] += u64x4(_mm256_mul_epu32(ai, __m256i(bk[j])));
+                        }
+                    }
+                }
+                for(size_t i = 0; i < gemm_mr; i++) {
+                    for(size_t j = 0; j < nv; j++) {
+                        acc[i][j] = gemm_reduce(acc[i][j], cr);
+                    }
+                }
+            }
+            for(size_t i = 0; i < gemm_mr; i++) {
+                for(size_t j = 0; j < nv; j++) {
+                    vector_cast<u64x4>(c[i * ldc + 4 * j]) = acc[i][j];
+                }
+            }
+        }
+    }
+
+    // Whether gemm below applies to base with its current modulus:
+    // residues of a and stored values of b must fit in 32 bits
+    // and at least one product must fit on top of a reduced sum.
+    // 32-bit modints are packed to the same 64-bit panels
+    template<math::modint_type base>
+    bool gemm_fits() {
+        uint64_t m = base::mod(), R = base::remod();
+        return R <= (uint64_t(1) << 32) && (uint64_t(-1) - impl::gemm_bound(m)) / m / R > 0;
+    }
+
+    // Whether dot below applies to base with its current modulus: it splits
+    // stored values into 32-bit halves, so products of residues with 2^32
+    // must fit on top of a reduced sum, regardless of remod
+    template<math::modint_type base>
+    bool dot_fits() {
+        uint64_t m = base::mod();
+        return m <= (uint64_t(1) << 32) && ((uint64_t(-1) - impl::gemm_bound(m)) / m >> 32) > 0;
+    }
+
+    // sum x[j] b[j] for j >= i with plain residues in x and any stored values in b.
+    // 64-bit ones are split into 32-bit halves summed like in gemm,
+    // 32-bit ones are widened to 64-bit lanes and have no high half.
+    // The vector loop starts at i rounded down to 4, so x must be zero there
+    template<math::modint_type base>
+    [[gnu::target("avx2")]] base dot(std::span<uint64_t const> x, std::span<base const> b, size_t i = 0) {
+        using namespace impl;
+        assert(dot_fits<base>() && size(x) == size(b));
+        const uint64_t mod = base::mod();
+        const uint64_t steps = (uint64_t(-1) - gemm_bound(mod)) / mod >> 32;
+        const uint64_t c = (uint64_t(1) << 32) % mod;
+        const u64x4 cr = u64x4() + c;
+        const size_t n = size(x);
+        u64x4 lo = {}, hi = {};
+        if(is_aligned(&x[0]) && is_aligned(&b[0])) {
+            i -= i % 4;
+            while(i + 3 < n) {
+                for(size_t r = std::min(n - 3, i + 4 * steps); i < r; i += 4) {
+                    auto xi = __m256i(vector_cast<u64x4 const>(x[i]));
+                    if constexpr (base::bits == 32) {
+                        auto bi = _mm256_cvtepu32_epi64(_mm_load_si128((__m128i const*)&b[i]));
+                        lo += u64x4(_mm256_mul_epu32(xi, bi));
+                    } else {
+                        auto bi = vector_cast<u64x4 const>(b[i]);
+                        lo += u64x4(_mm256_mul_epu32(xi, __m256i(bi)));
+                        hi += u64x4(_mm256_mul_epu32(xi, __m256i(bi >> 32)));
+                    }
+                }
+                lo = gemm_reduce(lo, cr);
+                hi = gemm_reduce(hi, cr);
+            }
+        }
+        uint64_t sum = 0;
+        for(size_t t = 0; t < 4; t++) {
+            sum = (sum + lo[t] % mod + hi[t] % mod * c) % mod;
+        }
+        for(; i < n; i++) {
+            sum = (sum + x[i] * (uint64_t(b[i].getr_direct()) % mod)) % mod;
+        }
+        base res;
+        res.setr_direct(typename base::UInt(sum));
+        return res;
+    }
+
+    // c(i, j) = sum a(i, t) b(t, j) for n x m by m x k matrices,
+    // a(i, t) and b(t, j) return base, c(i, j) returns base&
+    // Packed blocked product: B goes to panels of kc rows and nc columns,
+    // A to panels of mc rows, and the micro-kernel adds up mr x nr tiles of C.
+    // Plain residues of A times stored values of B are stored values of the product,
+    // they are summed in 64 bits and only reduced every few steps, and mod m at the end.
+    // Threads take contiguous blocks of rows of C and pack their own panels of B.
+    template<math::modint_type base>
+    [[gnu::target("avx2")]] void gemm(size_t n, size_t m, size_t k, auto &&a, auto &&b, auto &&c, size_t threads = num_threads()) {
+        using namespace impl;
+        assert(gemm_fits<base>());
+        const uint64_t mod = base::mod();
+        const uint64_t steps = (uint64_t(-1) - gemm_bound(mod)) / mod / uint64_t(base::remod());
+        const u64x4 cr = u64x4() + (uint64_t(1) << 32) % mod;
+        const size_t np = (n + gemm_mr - 1) / gemm_mr * gemm_mr;
+        const size_t kp = (k + gemm_nr - 1) / gemm_nr * gemm_nr;
+        std::vector<uint64_t, big_alloc<uint64_t>> cbuf(np * kp);
+        auto restore_mod = math::impl::mod_setter<base>();
+        // Spawning threads only pays off on large products
+        if(double(n) * double(m) * double(k) < double(1 << 24)) {
+            threads = 1;
+        }
+        parallel_for(np / gemm_mr, [&](size_t, size_t l, size_t r) {
+            restore_mod();
+            const size_t lo = l * gemm_mr, hi = r * gemm_mr;
+            // Panels are cut to the actual sizes, small products are common
+            const size_t kc_max = std::min(gemm_kc, m);
+            std::vector<uint64_t, big_alloc<uint64_t>> apack(kc_max * std::min(gemm_mc, hi - lo));
+            std::vector<uint64_t, big_alloc<uint64_t>> bpack(kc_max * std::min(gemm_nc, kp));
+            for(size_t jj = 0; jj < kp; jj += gemm_nc) {
+                const size_t nc = std::min(gemm_nc, kp - jj);
+                for(size_t kk = 0; kk < m; kk += gemm_kc) {
+                    const size_t kc = std::min(gemm_kc, m - kk);
+                    // bpack[j / nr][t][j % nr] = b(kk + t, jj + j), zero-padded
+                    for(size_t j0 = 0; j0 < nc; j0 += gemm_nr) {
+                        uint64_t* dst = &bpack[j0 * kc];
+                        for(size_t t = 0; t < kc; t++) {
+                            for(size_t j = 0; j < gemm_nr; j++) {
+                                size_t col = jj + j0 + j;
+                                dst[t * gemm_nr + j] = col < k ? b(kk + t, col).getr_direct() : 0;
+                            }
+                        }
+                    }
+                    for(size_t ii = lo; ii < hi; ii += gemm_mc) {
+                        const size_t mc = std::min(gemm_mc, hi - ii);
+                        // apack[i / mr][t][i % mr] = a(ii + i, kk + t), zero-padded
+                        for(size_t i0 = 0; i0 < mc; i0 += gemm_mr) {
+                            uint64_t* dst = &apack[i0 * kc];
+                            for(size_t i = 0; i < gemm_mr; i++) {
+                                size_t row = ii + i0 + i;
+                                for(size_t t = 0; t < kc; t++) {
+                                    dst[t * gemm_mr + i] = row < n ? a(row, kk + t).getr() : 0;
+                                }
+                            }
+                        }
+                        for(size_t j0 = 0; j0 < nc; j0 += gemm_nr) {
+                            for(size_t i0 = 0; i0 < mc; i0 += gemm_mr) {
+                                gemm_micro(kc, steps, &apack[i0 * kc], &bpack[j0 * kc],
+                                           &cbuf[(ii + i0) * kp + jj + j0], kp, cr);
+                            }
+                        }
+                    }
+                }
+            }
+            for(size_t i = lo; i < std::min(hi, n); i++) {
+                for(size_t j = 0; j < k; j++) {
+                    c(i, j).setr_direct(typename base::UInt(cbuf[i * kp + j] % mod));
+                }
+            }
+        }, threads);
+    }
+}
+#endif // CP_ALGO_LINALG_GEMM_HPP
@@ -2,69 +2,157 @@
 #define CP_ALGO_LINALG_MATRIX_HPP
 #include "../random/rng.hpp"
 #include "../math/common.hpp"
+#include "../util/big_alloc.hpp"
 #include "vector.hpp"
+#include "strassen.hpp"
+#include "../util/parallel.hpp"
 #include <iostream>
 #include <optional>
+#include <barrier>
 #include <cassert>
 #include <vector>
 #include <array>
+#include <span>
 namespace cp_algo::linalg {
     enum gauss_mode {normal, reverse};
 
+    // Row of a matrix, a view into its storage
+    // Unlike span, assignment copies the values into the row
+    template<typename base>
+    struct matrix_row: std::span<base> {
+        using Base = std::span<base>;
+        using Base::Base;
+        matrix_row(Base t): Base(t) {}
+
+        matrix_row& operator = (matrix_row const& t) {
+            assert(Base::size() == t.size());
+            std::ranges::copy(t, Base::begin());
+            return *this;
+        }
+        template<std::ranges::input_range R>
+        matrix_row& operator = (R &&r) {
+            std::ranges::copy(r, Base::begin());
+            return *this;
+        }
+
+        auto operator-() const {
+            return *this | std::views::transform([](auto x) {return -x;});
+        }
+        auto operator *(std::remove_const_t<base> t) const {
+            return *this | std::views::transform([t](auto x) {return x * t;});
+        }
+        matrix_row& operator *=(std::remove_const_t<base> t) {
+            for(auto &it: *this) {
+                it *= t;
+            }
+            return *this;
+        }
+        void read() {
+            for(auto &it: *this) {
+                std::cin >> it;
+            }
+        }
+        void print() const {
+            for(auto &it: *this) {
+                std::cout << it << " ";
+            }
+            std::cout << "\n";
+        }
+    };
+
+    // Forward iterator over the rows of a matrix, for range-for and begin/end below
+    template<typename M>
+    struct matrix_row_iterator {
+        using value_type = decltype(std::declval<M&>().row(0));
+        using difference_type = ptrdiff_t;
+        M* A = nullptr;
+        size_t i = 0;
+
+        value_type operator*() const {return A->row(i);}
+        matrix_row_iterator& operator++() {i++; return *this;}
+        matrix_row_iterator operator++(int) {auto t = *this; i++; return t;}
+        bool operator==(matrix_row_iterator const&) const = default;
+    };
+
+    // Dense row-major matrix in a single allocation, rows are padded
+    // to 32 bytes so that each of them is aligned for the SIMD kernels.
+    // It iterates over its rows like a vector of rows, but rows are
+    // matrix_row views: they can't change size, there is no push_back,
+    // and vec methods like reduce_by need a copy to vec_t or impl:: kernels
     template<typename base_t, class _vec_t = std::conditional_t<
         math::modint_type<base_t>,
         modint_vec<base_t>,
         vec<base_t>>>
-    struct matrix: std::vector<_vec_t> {
+    struct matrix {
         using vec_t = _vec_t;
         using base = base_t;
-        using Base = std::vector<vec_t>;
-        using Base::Base;
 
-        matrix(size_t n): Base(n, vec_t(n)) {}
-        matrix(size_t n, size_t m): Base(n, vec_t(m)) {}
+        matrix(): matrix(0, 0) {}
+        matrix(size_t n): matrix(n, n) {}
+        matrix(size_t n, size_t m): _n(n), _m(m), stride(padded(m)), data(n * stride) {}
 
-        matrix(Base const& t): Base(t) {}
-        matrix(Base &&t): Base(std::move(t)) {}
-        
+        // Matrix from a range of rows of the same size
         template<std::ranges::input_range R>
-        matrix(R &&r): Base(std::ranges::to<Base>(std::forward<R>(r))) {}
+            requires (!std::same_as<std::remove_cvref_t<R>, matrix>)
+        matrix(R &&r) {
+            auto rows = std::ranges::to<std::vector<vec_t>>(std::forward<R>(r));
+            *this = matrix(size(rows), rows.empty() ? 0 : size(rows[0]));
+            for(size_t i = 0; i < n(); i++) {
+                row(i) = rows[i];
+            }
+        }
+
+        size_t n() const {return _n;}
+        size_t m() const {return _m;}
 
-        size_t n() const {return size(*this);}
-        size_t m() const {return n() ? size(row(0)) : 0;}
-        
         void resize(size_t n, size_t m) {
-            Base::resize(n);
-            for(auto &it: *this) {
-                it.resize(m);
+            matrix res(n, m);
+            for(size_t i = 0; i < std::min(n, _n); i++) {
+                std::ranges::copy(row(i) | std::views::take(m), begin(res[i]));
             }
+            *this = std::move(res);
         }
 
-        auto& row(size_t i) {return (*this)[i];}
-        auto const& row(size_t i) const {return (*this)[i];}
+        matrix_row<base> row(size_t i) {return {data.data() + i * stride, _m};}
+        matrix_row<base const> row(size_t i) const {return {data.data() + i * stride, _m};}
+        matrix_row<base> operator[](size_t i) {return row(i);}
+        matrix_row<base const> operator[](size_t i) const {return row(i);}
 
-        auto elements() {return *this | std::views::join;}
-        auto elements() const {return *this | std::views::join;}
+        auto rows() {
+            return std::views::iota(size_t(0), n()) | std::views::transform([this](size_t i) {return row(i);});
+        }
+        auto rows() const {
+            return std::views::iota(size_t(0), n()) | std::views::transform([this](size_t i) {return row(i);});
+        }
+        auto elements() {return rows() | std::views::join;}
+        auto elements() const {return rows() | std::views::join;}
 
+        // Padding is kept zero, so whole-storage operations are fine
         matrix operator-() const {
-            return *this | std::views::transform([](auto x) {return vec_t(-x);});
+            matrix res = *this;
+            for(auto &it: res.data) {
+                it = -it;
+            }
+            return res;
         }
         matrix& operator+=(matrix const& t) {
-            for(auto [a, b]: std::views::zip(elements(), t.elements())) {
-                a += b;
+            assert(n() == t.n() && m() == t.m());
+            for(size_t i = 0; i < size(data); i++) {
+                data[i] += t.data[i];
             }
             return *this;
         }
         matrix& operator -=(matrix const& t) {
-            for(auto [a, b]: std::views::zip(elements(), t.elements())) {
-                a -= b;
+            assert(n() == t.n() && m() == t.m());
+            for(size_t i = 0; i < size(data); i++) {
+                data[i] -= t.data[i];
             }
             return *this;
         }
         matrix operator+(matrix const& t) const {return matrix(*this) += t;}
         matrix operator-(matrix const& t) const {return matrix(*this) -= t;}
         
-        matrix& operator *=(base t) {for(auto &it: *this) it *= t; return *this;}
+        matrix& operator *=(base t) {for(auto &it: data) it *= t; return *this;}
         matrix operator *(base t) const {return matrix(*this) *= t;}
         matrix& operator /=(base t) {return *this *= base(1) / t;}
         matrix operator /(base t) const {return matrix(*this) /= t;}
@@ -72,6 +160,11 @@ namespace cp_algo::linalg {
         // Make sure the result is matrix, not Base
         matrix& operator *=(matrix const& t) {return *this = *this * t;}
 
+        bool operator == (matrix const& t) const {
+            return n() == t.n() && m() == t.m() && std::ranges::equal(data, t.data);
+        }
+        bool operator != (matrix const& t) const {return !(*this == t);}
+
         void read_transposed() {
             for(size_t j = 0; j < m(); j++) {
                 for(size_t i = 0; i < n(); i++) {
@@ -80,13 +173,13 @@ namespace cp_algo::linalg {
             }
         }
         void read() {
-            for(auto &it: *this) {
-                it.read();
+            for(size_t i = 0; i < n(); i++) {
+                row(i).read();
             }
         }
         void print() const {
-            for(auto const& it: *this) {
-                it.print();
+            for(size_t i = 0; i < n(); i++) {
+                row(i).print();
             }
         }
 
@@ -108,7 +201,9 @@ namespace cp_algo::linalg {
         }
         static matrix random(size_t n, size_t m) {
             matrix res(n, m);
-            std::ranges::generate(res, std::bind(vec_t::random, m));
+            for(size_t i = 0; i < n; i++) {
+                std::ranges::generate(res[i], random::rng);
+            }
             return res;
         }
         static matrix random(size_t n) {
@@ -127,18 +222,18 @@ namespace cp_algo::linalg {
             assert(n() == b.n());
             matrix res(n(), m()+b.m());
             for(size_t i = 0; i < n(); i++) {
-                res[i] = row(i) | b[i];
+                std::ranges::copy(b[i], std::ranges::copy(row(i), begin(res[i])).out);
             }
             return res;
         }
         void assign_submatrix(auto viewx, auto viewy, matrix const& t) {
-            for(auto [a, b]: std::views::zip(*this | viewx, t)) {
+            for(auto [a, b]: std::views::zip(rows() | viewx, t.rows())) {
                 std::ranges::copy(b, begin(a | viewy));
             }
         }
         auto submatrix(auto viewx, auto viewy) const {
-            return *this | viewx | std::views::transform([viewy](auto const& y) {
-                return y | viewy;
+            return rows() | viewx | std::views::transform([viewy](auto const& y) {
+                return std::span(y) | viewy;
             });
         }
 
@@ -155,16 +250,55 @@ namespace cp_algo::linalg {
         matrix operator *(matrix const& b) const {
             assert(m() == b.n());
             matrix res(n(), b.m());
+            if constexpr (math::modint_type<base>) {
+                if(gemm_fits<base>()) {
+                    strassen<base>(n(), m(), b.m(), [&](size_t i, size_t j) {
+                        return row(i)[j];
+                    }, [&](size_t i, size_t j) {
+                        return b[i][j];
+                    }, [&](size_t i, size_t j) -> base& {
+                        return res[i][j];
+                    });
+                    return res;
+                }
+                // add_scaled works with 32-bit residues only
+                for(size_t i = 0; i < n(); i++) {
+                    for(size_t j = 0; j < m(); j++) {
+                        for(size_t t = 0; t < b.m(); t++) {
+                            res[i][t] += row(i)[j] * b[j][t];
+                        }
+                    }
+                }
+                return res;
+            }
             for(size_t i = 0; i < n(); i++) {
                 for(size_t j = 0; j < m(); j++) {
-                    res[i].add_scaled(b[j], row(i)[j]);
+                    impl::add_scaled<base>(res[i], b[j], row(i)[j]);
                 }
             }
-            return res.normalize();
+            return res;
         }
 
+        // x A for a row vector x, the rows of A are summed with lazy reduction
         vec_t apply(vec_t const& x) const {
-            return (matrix(1, x) * *this)[0];
+            assert(size(x) == n());
+            vec_t res(m());
+            if(!impl::lazy_fits<base>()) {
+                for(size_t i = 0; i < n(); i++) {
+                    for(size_t j = 0; j < m(); j++) {
+                        res[j] += x[i] * row(i)[j];
+                    }
+                }
+                return res;
+            }
+            for(size_t i = 0; i < n(); i++) {
+                impl::add_scaled<base>(res, row(i), x[i]);
+                if(i % 4 == 3) {
+                    impl::pseudonormalize<base>(res);
+                }
+            }
+            impl::normalize<base>(res);
+            return res;
         }
 
         matrix pow(uint64_t k) const {
@@ -173,34 +307,68 @@ namespace cp_algo::linalg {
         }
 
         matrix& normalize() {
-            for(auto &it: *this) {
-                it.normalize();
-            }
+            impl::normalize<base>(data);
             return *this;
         }
+        // Threads for row operations, which only pay off on large matrices
+        size_t row_threads(size_t threads) const {
+            return n() * m() < (1 << 18) ? 1 : std::min(threads, n());
+        }
         template<gauss_mode mode = normal>
-        void eliminate(size_t i, size_t k) {
-            auto kinv = base(1) / row(i).normalize()[k];
-            for(size_t j = (mode == normal) * i; j < n(); j++) {
-                if(j != i) {
-                    row(j).add_scaled(row(i), -row(j).normalize(k) * kinv);
+        void eliminate(size_t i, size_t k, size_t threads = num_threads()) {
+            impl::normalize<base>(row(i));
+            auto kinv = base(1) / row(i)[k];
+            size_t from = (mode == normal) * i;
+            auto restore_mod = math::impl::mod_setter<base>();
+            parallel_for(n() - from, [&](size_t, size_t l, size_t r) {
+                restore_mod();
+                for(size_t j = from + l; j < from + r; j++) {
+                    if(j != i) {
+                        impl::add_scaled<base>(row(j), row(i), -impl::normalize(row(j)[k]) * kinv);
+                        impl::pseudonormalize<base>(row(j));
+                    }
                 }
-            }
+            }, row_threads(threads));
         }
         template<gauss_mode mode = normal>
         void eliminate(size_t i) {
-            row(i).normalize();
+            auto [k, kinv] = pivot(i);
             for(size_t j = (mode == normal) * i; j < n(); j++) {
                 if(j != i) {
-                    row(j).reduce_by(row(i));
+                    reduce(j, i, k, kinv);
+                    impl::pseudonormalize<base>(row(j));
                 }
             }
         }
         template<gauss_mode mode = normal>
-        matrix& gauss() {
-            for(size_t i = 0; i < n(); i++) {
-                eliminate<mode>(i);
-            }
+        matrix& gauss(size_t threads = num_threads()) {
+            threads = std::max<size_t>(row_threads(threads), 1);
+            // Thread t owns rows t, t + threads, ... and reduces them by each row i in turn.
+            // Row i is ready once its owner reduced it by all rows before it,
+            // so the owner finds its pivot and one barrier per row is enough
+            std::vector<std::pair<size_t, base>> pivots(n());
+            std::barrier sync{ptrdiff_t(threads)};
+            auto restore_mod = math::impl::mod_setter<base>();
+            parallel_for(threads, [&](size_t t, size_t, size_t) {
+                restore_mod();
+                for(size_t i = 0; i < n(); i++) {
+                    if(i % threads == t) {
+                        pivots[i] = pivot(i);
+                    }
+                    sync.arrive_and_wait();
+                    auto [k, kinv] = pivots[i];
+                    size_t from = (mode == normal) * i;
+                    for(size_t j = from + (t + threads - from % threads) % threads; j < n(); j += threads) {
+                        if(j != i) {
+                            reduce(j, i, k, kinv);
+                            // Each row gets at most one update per pivot
+                            if(i % 4 == 3) {
+                                impl::pseudonormalize<base>(row(j));
+                            }
+                        }
+                    }
+                }
+            }, threads);
             return normalize();
         }
         template<gauss_mode mode = normal>
@@ -230,6 +398,79 @@ namespace cp_algo::linalg {
             return res;
         }
 
+        // Reduces a square matrix to the upper Hessenberg form in place
+        // by similarity transforms: for each column k, rows j > k + 1 are
+        // reduced by row k + 1 with factors c_j, then column k + 1 gets
+        // c_j times column j added, which is a dot product along each row
+        matrix& hessenberg(size_t threads = num_threads()) {
+            assert(n() == m());
+            threads = row_threads(threads);
+            auto restore_mod = math::impl::mod_setter<base>();
+            // Plain residues of c_j, zero for j <= k + 1
+            std::vector<uint64_t, big_alloc<uint64_t>> c(n());
+            // Otherwise rows are reduced after every update
+            const bool lazy = impl::lazy_fits<base>();
+            for(size_t k = 0; k + 2 < n(); k++) {
+                // dot reads c from k + 2 rounded down, even if this column is skipped
+                c[k + 1] = 0;
+                size_t i = k + 1;
+                while(i < n() && impl::normalize(row(i)[k]) == base(0)) {
+                    i++;
+                }
+                if(i == n()) {
+                    continue;
+                }
+                if(i != k + 1) {
+                    std::ranges::swap_ranges(row(i), row(k + 1));
+                    for(size_t r = 0; r < n(); r++) {
+                        std::swap(row(r)[i], row(r)[k + 1]);
+                    }
+                }
+                impl::normalize<base>(row(k + 1));
+                auto kinv = base(1) / row(k + 1)[k];
+                bool nonzero = false;
+                for(size_t j = k + 2; j < n(); j++) {
+                    c[j] = (impl::normalize(row(j)[k]) * kinv).getr();
+                    nonzero |= c[j] != 0;
+                }
+                if(!nonzero) {
+                    continue;
+                }
+                // Column k + 1 of row j gets sum c_t row(j)[t]
+                auto add_column = [&](size_t j) {
+                    if constexpr (math::modint_type<base>) {
+                        if(dot_fits<base>()) {
+                            row(j)[k + 1] += dot<base>(c, row(j), k + 2);
+                            return;
+                        }
+                    }
+                    for(size_t t = k + 2; t < n(); t++) {
+                        row(j)[k + 1] += base(c[t]) * row(j)[t];
+                    }
+                };
+                // Both updates are done at once while the row is in cache,
+                // except for row k + 1, which is needed as is by the others
+                parallel_for(n(), [&](size_t, size_t l, size_t r) {
+                    restore_mod();
+                    for(size_t j = l; j < r; j++) {
+                        if(j > k + 1) {
+                            reduce(j, k + 1, k, kinv);
+                            if(lazy) {
+                                impl::pseudonormalize<base>(row(j));
+                            } else {
+                                impl::normalize<base>(row(j));
+                            }
+                        }
+                        if(j != k + 1) {
+                            add_column(j);
+                        }
+                    }
+                }, threads);
+                add_column(k + 1);
+            }
+            return normalize();
+        }
+
         std::pair<base, matrix> inv() const {
             assert(n() == m());
             matrix b = *this | eye(n());
@@ -287,7 +528,7 @@ namespace cp_algo::linalg {
             for(size_t j = 0; j < lim; j++) {
                 for(size_t i = rk + 1; i < n() && row(rk)[j] == base(0); i++) {
                     if(row(i)[j] != base(0)) {
-                        std::swap(row(i), row(rk));
+                        std::ranges::swap_ranges(row(i), row(rk));
                         row(rk) = -row(rk);
                     }
                 }
@@ -300,8 +541,42 @@ namespace cp_algo::linalg {
             }
             return std::array{pivots, free};
         }
+    private:
+        size_t _n = 0, _m = 0, stride = 0;
+        std::vector<base, big_alloc<base>> data;
+
+        static size_t padded(size_t m) {
+            const size_t k = std::max<size_t>(1, 32 / sizeof(base));
+            return (m + k - 1) / k * k;
+        }
+        // Normalizes row i, returns its first non-zero position k and 1 / row(i)[k]
+        std::pair<size_t, base> pivot(size_t i) {
+            auto r = row(i);
+            impl::normalize<base>(r);
+            size_t k = std::ranges::find_if(r, [](base x) {return x != base(0);}) - begin(r);
+            return {k, k < m() ? base(1) / r[k] : base(0)};
+        }
+        // Subtracts row i with pivot k from row j to make row(j)[k] zero
+        void reduce(size_t j, size_t i, size_t k, base kinv) {
+            if(k < m()) {
+                impl::add_scaled<base>(row(j), row(i), -impl::normalize(row(j)[k]) * kinv, k);
+            }
+        }
     };
     template<typename base_t>
     auto operator *(base_t t, matrix<base_t> const& A) {return A * t;}
+
+    // Free functions rather than members, so that they don't hide
+    // std::size, std::begin and std::end inside of matrix
+    template<typename base, class vec_t>
+    size_t size(matrix<base, vec_t> const& A) {return A.n();}
+    template<typename base, class vec_t>
+    auto begin(matrix<base, vec_t> &A) {return matrix_row_iterator<matrix<base, vec_t>>{&A, 0};}
+    template<typename base, class vec_t>
+    auto end(matrix<base, vec_t> &A) {return matrix_row_iterator<matrix<base, vec_t>>{&A, A.n()};}
+    template<typename base, class vec_t>
+    auto begin(matrix<base, vec_t> const& A) {return matrix_row_iterator<matrix<base, vec_t> const>{&A, 0};}
+    template<typename base, class vec_t>
+    auto end(matrix<base, vec_t> const& A) {return matrix_row_iterator<matrix<base, vec_t> const>{&A, A.n()};}
 }
 #endif // CP_ALGO_LINALG_MATRIX_HPP
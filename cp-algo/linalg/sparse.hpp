@@ -0,0 +1,234 @@
+#ifndef CP_ALGO_LINALG_SPARSE_HPP
+#define CP_ALGO_LINALG_SPARSE_HPP
+#include "../math/poly.hpp"
+#include "../util/big_alloc.hpp"
+#include "../util/parallel.hpp"
+#include "matrix.hpp"
+#include <algorithm>
+#include <optional>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <tuple>
+namespace cp_algo::linalg {
+    // n x m matrix in compressed sparse row form, entries of row i
+    // are at [start[i], start[i + 1]) in cols and vals
+    // Only products with vectors are available, and det, rank, solve and minpoly
+    // are found from the minimal polynomials of Krylov sequences (Wiedemann),
+    // in O(n) products with vectors and O(n log^2 n) for min_rec.
+    // They are randomized and only make sense over large prime fields.
+    template<typename base_t, class _vec_t = std::conditional_t<
+        math::modint_type<base_t>,
+        modint_vec<base_t>,
+        vec<base_t>>>
+    struct sparse_matrix {
+        using vec_t = _vec_t;
+        using base = base_t;
+        using polyn = math::poly_t<base>;
+
+        sparse_matrix(): sparse_matrix(0, 0, {}) {}
+        // Entries (i, j, x) in any order, repeated positions are summed up
+        sparse_matrix(size_t n, size_t m, std::vector<std::tuple<size_t, size_t, base>> const& entries):
+            _n(n), _m(m), start(n + 1), cols(size(entries)), vals(size(entries)) {
+            assert(m <= UINT32_MAX);
+            for(auto const& [i, j, x]: entries) {
+                assert(i < n && j < m);
+                start[i + 1]++;
+            }
+            for(size_t i = 0; i < n; i++) {
+                start[i + 1] += start[i];
+            }
+            auto pos = start;
+            for(auto const& [i, j, x]: entries) {
+                cols[pos[i]] = uint32_t(j);
+                vals[pos[i]++] = x;
+            }
+        }
+
+        size_t n() const {return _n;}
+        size_t m() const {return _m;}
+        size_t nnz() const {return size(vals);}
+
+        sparse_matrix T() const {
+            std::vector<std::tuple<size_t, size_t, base>> entries;
+            entries.reserve(nnz());
+            for(size_t i = 0; i < n(); i++) {
+                for(size_t t = start[i]; t < start[i + 1]; t++) {
+                    entries.emplace_back(cols[t], i, vals[t]);
+                }
+            }
+            return sparse_matrix(m(), n(), entries);
+        }
+
+        // x A for a row vector x, same as matrix::apply
+        vec_t apply(vec_t const& x) const {
+            assert(size(x) == n());
+            vec_t res(m());
+            for(size_t i = 0; i < n(); i++) {
+                for(size_t t = start[i]; t < start[i + 1]; t++) {
+                    res[cols[t]] += x[i] * vals[t];
+                }
+            }
+            return res;
+        }
+        // x A^T, which is A x for a column vector x
+        // Rows are independent here, so this is the product used below
+        vec_t apply_T(vec_t const& x, size_t threads = num_threads()) const {
+            assert(size(x) == m());
+            vec_t res(n());
+            auto restore_mod = math::impl::mod_setter<base>();
+            // Spawning threads only pays off on large matrices
+            parallel_for(n(), [&](size_t, size_t l, size_t r) {
+                restore_mod();
+                if constexpr (math::modint_type<base>) {
+                    // Plain residues times stored values are below 2^63 and are
+                    // summed in 64 bits, keeping the sum below K, a multiple of mod
+                    const uint64_t mod = base::mod(), K = (uint64_t(1) << 63) / mod * mod;
+                    if(uint64_t(base::remod()) <= K / mod) {
+                        for(size_t i = l; i < r; i++) {
+                            uint64_t sum = 0;
+                            for(size_t t = start[i]; t < start[i + 1]; t++) {
+                                sum += uint64_t(vals[t].getr()) * x[cols[t]].getr_direct();
+                                sum = std::min(sum, sum - K);
+                            }
+                            res[i].setr_direct(typename base::UInt(sum % mod));
+                        }
+                        return;
+                    }
+                }
+                for(size_t i = l; i < r; i++) {
+                    base sum = 0;
+                    for(size_t t = start[i]; t < start[i + 1]; t++) {
+                        sum += vals[t] * x[cols[t]];
+                    }
+                    res[i] = sum;
+                }
+            }, nnz() < (1 << 18) ? 1 : threads);
+            return res;
+        }
+
+        // Minimal polynomial of A, monic, it may be a proper divisor
+        // with probability at most 2 deg / mod
+        polyn minpoly() const {
+            assert(n() == m());
+            auto Q = krylov_minpoly(n(), [&](vec_t const& v) {
+                return apply_T(v);
+            }, vec_t::random(n()));
+            return Q / Q.lead();
+        }
+
+        // For nonsingular A, the minimal polynomial of A D with a random
+        // diagonal D is its characteristic polynomial w.h.p., and if Q(0) = 0
+        // for the minimal polynomial Q of a sequence, A is surely singular
+        base det() const {
+            assert(n() == m());
+            if(n() == 0) {
+                return 1;
+            }
+            while(true) {
+                auto D = vec_t::random(n());
+                base Ddet = 1;
+                for(auto const& d: D) {
+                    Ddet *= d;
+                }
+                if(Ddet == base(0)) {
+                    continue;
+                }
+                auto Q = krylov_minpoly(n(), [&](vec_t v) {
+                    for(size_t i = 0; i < n(); i++) {
+                        v[i] *= D[i];
+                    }
+                    return apply_T(v);
+                }, vec_t::random(n()));
+                if(Q[0] == base(0)) {
+                    return 0;
+                }
+                if(size_t(Q.deg()) == n()) {
+                    // det(AD) = (-1)^n Q(0) / lead(Q)
+                    auto res = Q[0] / (Q.lead() * Ddet);
+                    return n() % 2 ? -res : res;
+                }
+            }
+        }
+
+        // The minimal polynomial of D1 A^T D2 A D1 with random diagonal D1 and D2
+        // is x^e f(x) with deg f = rank(A) w.h.p., and never more than that
+        size_t rank() const {
+            if(n() == 0 || m() == 0) {
+                return 0;
+            }
+            auto At = T();
+            auto D1 = vec_t::random(m()), D2 = vec_t::random(n());
+            auto Q = krylov_minpoly(m(), [&](vec_t v) {
+                for(size_t i = 0; i < m(); i++) {
+                    v[i] *= D1[i];
+                }
+                auto w = apply_T(v);
+                for(size_t i = 0; i < n(); i++) {
+                    w[i] *= D2[i];
+                }
+                v = At.apply_T(w);
+                for(size_t i = 0; i < m(); i++) {
+                    v[i] *= D1[i];
+                }
+                return v;
+            }, vec_t::random(m()));
+            int e = 0;
+            while(Q[e] == base(0)) {
+                e++;
+            }
+            return size_t(Q.deg() - e);
+        }
+
+        // x such that A x = b for a square A, found from Q(A) b = 0
+        // for the minimal polynomial Q of b when Q(0) != 0.
+        // This covers all nonsingular A, otherwise it may return nullopt
+        // even though a solution exists
+        std::optional<vec_t> solve(vec_t const& b) const {
+            assert(n() == m() && size(b) == n());
+            while(true) {
+                auto Q = krylov_minpoly(n(), [&](vec_t const& v) {
+                    return apply_T(v);
+                }, b);
+                if(Q[0] == base(0)) {
+                    return std::nullopt;
+                }
+                // x = -(Q(A) - Q(0)) / A b / Q(0) by Horner's rule
+                vec_t x(n());
+                for(int i = Q.deg(); i > 0; i--) {
+                    x = apply_T(x);
+                    for(size_t j = 0; j < n(); j++) {
+                        x[j] += Q[i] * b[j];
+                    }
+                }
+                x *= -base(1) / Q[0];
+                // Q may be a proper divisor of the minimal polynomial of b
+                if(std::ranges::equal(apply_T(x), b)) {
+                    return x;
+                }
+            }
+        }
+    private:
+        // Minimal polynomial of u M^i v for a random u and i < 2d,
+        // where M is d x d and given by op(v) = M v
+        static polyn krylov_minpoly(size_t d, auto &&op, vec_t v) {
+            auto u = vec_t::random(d);
+            typename polyn::Vector seq(2 * d);
+            for(size_t i = 0; i < 2 * d; i++) {
+                if(i) {
+                    v = op(v);
+                }
+                for(size_t j = 0; j < d; j++) {
+                    seq[i] += u[j] * v[j];
+                }
+            }
+            return polyn(seq).min_rec(2 * d);
+        }
+
+        size_t _n, _m;
+        std::vector<size_t> start;
+        std::vector<uint32_t> cols;
+        std::vector<base, big_alloc<base>> vals;
+    };
+}
+#endif // CP_ALGO_LINALG_SPARSE_HPP
@@ -0,0 +1,130 @@
+#ifndef CP_ALGO_LINALG_STRASSEN_HPP
+#define CP_ALGO_LINALG_STRASSEN_HPP
+#include "gemm.hpp"
+#include "../util/big_alloc.hpp"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+namespace cp_algo::linalg {
+    namespace impl {
+        // Default cutoff of strassen below, products with all sides
+        // below 2 * strassen_cutoff go straight to gemm
+        constexpr size_t strassen_cutoff = 1024;
+
+        // Row-major block inside a bigger buffer with row stride ld
+        template<typename base>
+        struct block {
+            base* p;
+            size_t ld;
+            base& operator()(size_t i, size_t j) const {return p[i * ld + j];}
+            block sub(size_t i, size_t j) const {return {p + i * ld + j, ld};}
+        };
+
+        // dst = op(x, y) elementwise on n x m blocks
+        template<typename base>
+        void combine(size_t n, size_t m, block<base> dst, block<base> x, block<base> y, auto &&op) {
+            for(size_t i = 0; i < n; i++) {
+                for(size_t j = 0; j < m; j++) {
+                    dst(i, j) = op(x(i, j), y(i, j));
+                }
+            }
+        }
+
+        // Temporaries of one level of strassen_rec and everything below it
+        inline size_t strassen_memory(size_t n, size_t m, size_t k, size_t levels) {
+            return levels ? (4 * n * m + 4 * m * k + 7 * n * k) / 4 + strassen_memory(n / 2, m / 2, k / 2, levels - 1) : 0;
+        }
+
+        // c = a b for n x m by m x k blocks with sides divisible by 2^levels,
+        // temporaries are taken from arena in stack order
+        // Winograd's schedule with 7 products and 15 additions on each level
+        template<typename base>
+        void strassen_rec(size_t n, size_t m, size_t k, block<base> a, block<base> b, block<base> c, size_t levels, base* arena) {
+            if(levels == 0) {
+                gemm<base>(n, m, k, a, b, c);
+                return;
+            }
+            n /= 2, m /= 2, k /= 2;
+            auto take = [&](size_t rows, size_t cols) {
+                block<base> res{arena, cols};
+                arena += rows * cols;
+                return res;
+            };
+            auto A11 = a, A12 = a.sub(0, m), A21 = a.sub(n, 0), A22 = a.sub(n, m);
+            auto B11 = b, B12 = b.sub(0, k), B21 = b.sub(m, 0), B22 = b.sub(m, k);
+            auto C11 = c, C12 = c.sub(0, k), C21 = c.sub(n, 0), C22 = c.sub(n, k);
+            auto S1 = take(n, m), S2 = take(n, m), S3 = take(n, m), S4 = take(n, m);
+            auto T1 = take(m, k), T2 = take(m, k), T3 = take(m, k), T4 = take(m, k);
+            auto M1 = take(n, k), M2 = take(n, k), M3 = take(n, k), M4 = take(n, k);
+            auto M5 = take(n, k), M6 = take(n, k), M7 = take(n, k);
+            auto add = [](base x, base y) {return x + y;};
+            auto sub = [](base x, base y) {return x - y;};
+            combine(n, m, S1, A21, A22, add);
+            combine(n, m, S2, S1, A11, sub);
+            combine(n, m, S3, A11, A21, sub);
+            combine(n, m, S4, A12, S2, sub);
+            combine(m, k, T1, B12, B11, sub);
+            combine(m, k, T2, B22, T1, sub);
+            combine(m, k, T3, B22, B12, sub);
+            combine(m, k, T4, T2, B21, sub);
+            strassen_rec(n, m, k, A11, B11, M1, levels - 1, arena);
+            strassen_rec(n, m, k, A12, B21, M2, levels - 1, arena);
+            strassen_rec(n, m, k, S4, B22, M3, levels - 1, arena);
+            strassen_rec(n, m, k, A22, T4, M4, levels - 1, arena);
+            strassen_rec(n, m, k, S1, T1, M5, levels - 1, arena);
+            strassen_rec(n, m, k, S2, T2, M6, levels - 1, arena);
+            strassen_rec(n, m, k, S3, T3, M7, levels - 1, arena);
+            // C11 = M1 + M2, U2 = M1 + M6, U3 = U2 + M7, U4 = U2 + M5,
+            // C12 = U4 + M3, C21 = U3 - M4, C22 = U3 + M5
+            combine(n, k, C11, M1, M2, add);
+            combine(n, k, M6, M1, M6, add);
+            combine(n, k, M7, M6, M7, add);
+            combine(n, k, M6, M6, M5, add);
+            combine(n, k, C12, M6, M3, add);
+            combine(n, k, C21, M7, M4, sub);
+            combine(n, k, C22, M7, M5, add);
+        }
+    }
+
+    // c(i, j) = sum a(i, t) b(t, j) like gemm, but with Strassen-Winograd
+    // recursion while all sides are at least 2 * cutoff.
+    // Sides are zero-padded to multiples of 2^levels and the temporaries
+    // come from a thread-local arena that is kept between calls
+    template<math::modint_type base>
+    void strassen(size_t n, size_t m, size_t k, auto &&a, auto &&b, auto &&c, size_t cutoff = impl::strassen_cutoff) {
+        using impl::block;
+        assert(cutoff > 0);
+        size_t levels = 0;
+        while(std::min({n, m, k}) >> (levels + 1) >= cutoff) {
+            levels++;
+        }
+        if(levels == 0) {
+            gemm<base>(n, m, k, a, b, c);
+            return;
+        }
+        auto pad = [&](size_t x) {
+            return (x + (size_t(1) << levels) - 1) >> levels << levels;
+        };
+        size_t np = pad(n), mp = pad(m), kp = pad(k);
+        thread_local std::vector<base, big_alloc<base>> arena;
+        arena.assign(np * mp + mp * kp + np * kp + impl::strassen_memory(np, mp, kp, levels), base(0));
+        block<base> A{arena.data(), mp}, B{A.p + np * mp, kp}, C{B.p + mp * kp, kp};
+        for(size_t i = 0; i < n; i++) {
+            for(size_t j = 0; j < m; j++) {
+                A(i, j) = a(i, j);
+            }
+        }
+        for(size_t i = 0; i < m; i++) {
+            for(size_t j = 0; j < k; j++) {
+                B(i, j) = b(i, j);
+            }
+        }
+        impl::strassen_rec(np, mp, kp, A, B, C, levels, C.p + np * kp);
+        for(size_t i = 0; i < n; i++) {
+            for(size_t j = 0; j < k; j++) {
+                c(i, j) = C(i, j);
+            }
+        }
+    }
+}
+#endif // CP_ALGO_LINALG_STRASSEN_HPP
@@ -12,7 +12,100 @@
 #include <iterator>
 #include <cassert>
 #include <ranges>
+#include <span>
 namespace cp_algo::linalg {
+    // Row kernels shared by standalone vectors and matrix rows
+    namespace impl {
+        // a[j] += scale * b[j] for j >= i. For 64-bit modints the sum is lazy,
+        // each call adds less than m * remod to the stored values of a,
+        // and pseudonormalize must be called at least every 4 calls.
+        // This keeps them below 8 m^2 + 4 m * remod, see lazy_fits.
+        // 32-bit modints are kept reduced: scale * b[j] is a Montgomery product
+        // on 64-bit lanes, so rows take half the memory and need no pseudonormalize
+        template<typename base>
+        void add_scaled(std::span<base> a, std::span<base const> b, base scale, size_t i = 0) {
+            assert(size(a) == size(b));
+            if(scale == base(0)) {
+                return;
+            }
+            size_t n = size(a);
+            if constexpr (math::modint_type<base> && base::bits == 32) {
+#ifdef __AVX2__
+                // Stored values below 2m stay below 4m <= 2^32 after the sum
+                const uint32_t mod = base::mod();
+                if(mod % 2 && mod <= (1u << 30) && is_aligned(&a[0]) && is_aligned(&b[0])) {
+                    const uint32_t imod = -math::inv2(mod);
+                    const u32x8 scaler = u32x8() + uint32_t((uint64_t(scale.getr()) << 32) % mod);
+                    for(i -= i % 8; i + 7 < n; i += 8) {
+                        auto &ai = vector_cast<u32x8>(a[i]);
+                        auto bi = vector_cast<u32x8 const>(b[i]);
+                        auto r = ai + montgomery_mul(bi, scaler, mod, imod);
+                        r = u32x8(_mm256_min_epu32(__m256i(r), __m256i(r - 2 * mod)));
+                        ai = u32x8(_mm256_min_epu32(__m256i(r), __m256i(r - mod)));
+                    }
+                }
+#endif
+                for(; i < n; i++) {
+                    a[i] += scale * b[i];
+                }
+            } else if constexpr (math::modint_type<base>) {
+                static_assert(base::bits >= 64, "Only 32-bit and wide modint types for linalg");
+                u64x4 scaler = u64x4() + scale.getr();
+                if (is_aligned(&a[0]) && is_aligned(&b[0])) // verify we're not in SSO
+                for(i -= i % 4; i + 3 < n; i += 4) {
+                    auto &ai = vector_cast<u64x4>(a[i]);
+                    auto bi = vector_cast<u64x4 const>(b[i]);
+#ifdef __AVX2__
+                    ai += u64x4(_mm256_mul_epu32(__m256i(scaler), __m256i(bi)));
+#else
+                    ai += scaler * bi;
+#endif
+                }
+                for(; i < n; i++) {
+                    a[i].add_unsafe(b[i].getr_direct() * scale.getr());
+                }
+            } else {
+                for(; i < n; i++) {
+                    a[i] += scale * b[i];
+                }
+            }
+        }
+        // Whether the lazy sums of add_scaled stay below 2^64 for the current modulus
+        template<typename base>
+        bool lazy_fits() {
+            if constexpr (math::modint_type<base> && base::bits >= 64) {
+                uint64_t m = base::mod(), R = base::remod();
+                return m < (uint64_t(1) << 30) && (uint64_t(-1) - 8 * m * m) / 4 / m >= R;
+            } else {
+                return true;
+            }
+        }
+        template<typename base>
+        void pseudonormalize(std::span<base> a) {
+            if constexpr (math::modint_type<base>) {
+                if constexpr (base::bits >= 64) {
+                    for(auto &it: a) {
+                        it.pseudonormalize();
+                    }
+                }
+            }
+        }
+        template<typename base>
+        base normalize(base &x) {
+            if constexpr (math::modint_type<base>) {
+                return x.normalize();
+            } else {
+                return x;
+            }
+        }
+        template<typename base>
+        void normalize(std::span<base> a) {
+            for(auto &it: a) {
+                normalize(it);
+            }
+        }
+    }
+
     template<typename base, class Alloc = big_alloc<base>>
     struct vec: std::basic_string<base, std::char_traits<base>, Alloc> {
         using Base = std::basic_string<base, std::char_traits<base>, Alloc>;
@@ -42,18 +135,21 @@ namespace cp_algo::linalg {
             return *this;
         }
 
-        virtual void add_scaled(vec const& b, base scale, size_t i = 0) {
+        void add_scaled(vec const& b, base scale, size_t i = 0) {
             if(scale != base(0)) {
-                for(; i < size(*this); i++) {
-                    (*this)[i] += scale * b[i];
+                impl::add_scaled<base>(*this, b, scale, i);
+                if(++counter == 4) {
+                    impl::pseudonormalize<base>(*this);
+                    counter = 0;
                 }
             }
         }
-        virtual vec const& normalize() {
-            return static_cast<vec&>(*this);
+        vec const& normalize() {
+            impl::normalize<base>(*this);
+            return *this;
         }
-        virtual base normalize(size_t i) {
-            return (*this)[i];
+        base normalize(size_t i) {
+            return impl::normalize((*this)[i]);
         }
         void read() {
             for(auto &it: *this) {
@@ -102,8 +198,11 @@ namespace cp_algo::linalg {
     private:
         size_t pivot = -1;
         base pivot_inv;
+        size_t counter = 0;
     };
 
+    // Kept for the default vector type of modint matrices,
+    // the lazy reduction is chosen by the kernels in impl
     template<math::modint_type base, class Alloc = big_alloc<base>>
     struct modint_vec: vec<base, Alloc> {
         using Base = vec<base, Alloc>;
@@ -111,45 +210,6 @@ namespace cp_algo::linalg {
 
         modint_vec(Base const& t): Base(t) {}
         modint_vec(Base &&t): Base(std::move(t)) {}
-
-        void add_scaled(Base const& b, base scale, size_t i = 0) override {
-            static_assert(base::bits >= 64, "Only wide modint types for linalg");
-            if(scale != base(0)) {
-                assert(Base::size() == b.size());
-                size_t n = size(*this);
-                u64x4 scaler = u64x4() + scale.getr();
-                if (is_aligned(&(*this)[0]) && is_aligned(&b[0])) // verify we're not in SSO
-                for(i -= i % 4; i + 3 < n; i += 4) {
-                    auto &ai = vector_cast<u64x4>((*this)[i]);
-                    auto bi = vector_cast<u64x4 const>(b[i]);
-#ifdef __AVX2__
-                    ai += u64x4(_mm256_mul_epu32(__m256i(scaler), __m256i(bi)));
-#else
-                    ai += scaler * bi;
-#endif
-                }
-                for(; i < n; i++) {
-                    (*this)[i].add_unsafe(b[i].getr_direct() * scale.getr());
-                }
-                if(++counter == 4) {
-                    for(auto &it: *this) {
-                        it.pseudonormalize();
-                    }
-                    counter = 0;
-                }
-            }
-        }
-        Base const& normalize() override {
-            for(auto &it: *this) {
-                it.normalize();
-            }
-            return *this;
-        }
-        base normalize(size_t i) override {
-            return (*this)[i].normalize();
-        }
-    private:
-        size_t counter = 0;
     };
 }
 #endif // CP_ALGO_LINALG_VECTOR_HPP
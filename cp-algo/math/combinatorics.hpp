@@ -1,78 +1,298 @@
 #ifndef CP_ALGO_MATH_COMBINATORICS_HPP
 #define CP_ALGO_MATH_COMBINATORICS_HPP
 #include "../math/common.hpp"
+#include "../number_theory/modint.hpp"
+#include "../util/big_alloc.hpp"
+#include "../util/simd.hpp"
+#include <unordered_map>
+#include <algorithm>
 #include <cassert>
 #include <ranges>
+#include <vector>
+#include <span>
 namespace cp_algo::math {
-    // fact/rfact/small_inv are caching
-    // Beware of usage with dynamic mod
+    // out[i] = scale * prod_{j <= i} (x0 + j * step) for i < n, step = +-1
+    // Works in blocks of 32 chains of length 64 that run in u32x8
+    // Montgomery arithmetic, then rescales each chain by the product
+    // of the preceding ones while the block is still in L1.
     template<typename T>
-    T fact(auto n) {
-        static std::vector<T> F(maxn);
-        static bool init = false;
-        if(!init) {
-            F[0] = T(1);
-            for(int i = 1; i < maxn; i++) {
-                F[i] = F[i - 1] * T(i);
+    [[gnu::target("avx2")]] void linear_prefix_prod(T scale, int64_t x0, int step, auto &&out, size_t n) {
+        constexpr size_t accum = 4;
+        constexpr size_t simd_size = 8;
+        constexpr size_t len = 64;
+        constexpr size_t block = accum * simd_size * len;
+        size_t blocks = 0;
+        T cur = scale;
+        if constexpr (modint_type<T>) {
+            if(T::bits <= 32 && T::mod() % 2 && T::mod() < (1 << 30)) {
+                blocks = n / block;
+            }
+            if(blocks) {
+                const uint32_t mod = uint32_t(T::mod());
+                const uint32_t imod = -inv2(mod);
+                auto to_mont = [&](T x) {
+                    return uint32_t((uint64_t(x.getr()) << 32) % mod);
+                };
+                const u32x8 stepv = u32x8() + to_mont(T(step));
+                const u32x8 jumpv = u32x8() + to_mont(T(int64_t(block - len) * step));
+                u32x8 x[accum], acc[accum], mul[accum];
+                for(size_t z = 0; z < accum; z++) {
+                    for(size_t j = 0; j < simd_size; j++) {
+                        x[z][j] = to_mont(T(x0 + int64_t((z * simd_size + j) * len) * step));
+                    }
+                }
+                u32x8 prods[len][accum];
+                for(size_t b = 0; b < blocks; b++) {
+                    for(size_t z = 0; z < accum; z++) {
+                        acc[z] = u32x8() + 1;
+                    }
+                    for(size_t i = 0; i < len; i++) {
+                        for(size_t z = 0; z < accum; z++) {
+                            acc[z] = montgomery_mul(acc[z], x[z], mod, imod);
+                            prods[i][z] = acc[z];
+                            x[z] += stepv;
+                            x[z] = x[z] >= mod ? x[z] - mod : x[z];
+                        }
+                    }
+                    for(size_t z = 0; z < accum; z++) {
+                        x[z] += jumpv;
+                        x[z] = x[z] >= mod ? x[z] - mod : x[z];
+                        for(size_t j = 0; j < simd_size; j++) {
+                            mul[z][j] = to_mont(cur);
+                            cur *= T(acc[z][j]);
+                        }
+                    }
+                    for(size_t i = 0; i < len; i++) {
+                        for(size_t z = 0; z < accum; z++) {
+                            auto v = montgomery_mul(prods[i][z], mul[z], mod, imod);
+                            v = v >= mod ? v - mod : v;
+                            for(size_t j = 0; j < simd_size; j++) {
+                                out[b * block + (z * simd_size + j) * len + i].setr(typename T::UInt(v[j]));
+                            }
+                        }
+                    }
+                }
             }
-            init = true;
         }
-        return F[n];
+        for(size_t i = blocks * block; i < n; i++) {
+            cur *= T(x0 + int64_t(i) * step);
+            out[i] = cur;
+        }
     }
-    // Only works for modint types
+
+    // Thread-local instance of Data, separate for each modulus of T
+    template<typename T, typename Data>
+    Data& mod_cached() {
+        if constexpr (modint_type<T>) {
+            using Int = typename T::Int;
+            thread_local std::unordered_map<Int, Data> cache;
+            thread_local Int last_mod = 0;
+            thread_local Data *last = nullptr;
+            if(!last || last_mod != T::mod()) {
+                last_mod = T::mod();
+                last = &cache[last_mod];
+            }
+            return *last;
+        } else {
+            thread_local Data data;
+            return data;
+        }
+    }
+
+    // Factorials, inverse factorials and inverses of 1, 2, ...
+    // Grows by doubling on demand. Tables are thread-local and,
+    // for modint types, keyed by modulus, so they are safe to use
+    // with dynamic_modint across threads and with_mod switches.
     template<typename T>
-    T rfact(auto n) {
-        static std::vector<T> F(maxn);
-        static bool init = false;
-        if(!init) {
-            int t = (int)std::min<int64_t>(T::mod(), maxn) - 1;
-            F[t] = T(1) / fact<T>(t);
-            for(int i = t - 1; i >= 0; i--) {
-                F[i] = F[i + 1] * T(i + 1);
+    struct fact_table {
+        std::vector<T, big_alloc<T>> F = {T(1)}, RF, I;
+
+        static fact_table& get() {
+            return mod_cached<T, fact_table>();
+        }
+
+        // Largest n for which 1/n! exists
+        static size_t limit() {
+            if constexpr (modint_type<T>) {
+                return size_t(T::mod()) - 1;
+            } else {
+                return size_t(-1);
+            }
+        }
+
+        void grow_fact(size_t n) {
+            if(n < size(F)) {
+                return;
+            }
+            size_t lo = size(F);
+            size_t hi = std::max(2 * lo, std::bit_ceil(n + 1));
+            if constexpr (modint_type<T>) {
+                // n! = 0 for n >= mod, no need to store these
+                hi = std::min(hi, limit() + 1);
+            }
+            F.resize(hi);
+            linear_prefix_prod(F[lo - 1], int64_t(lo), 1, std::span(F).subspan(lo), hi - lo);
+        }
+        void grow_rfact(size_t n) {
+            if(n < size(RF)) {
+                return;
+            }
+            assert(n <= limit());
+            grow_fact(n);
+            size_t lo = size(RF), hi = size(F);
+            RF.resize(hi);
+            I.resize(hi);
+            RF[hi - 1] = T(1) / F[hi - 1];
+            // RF[i] = RF[hi - 1] * (i + 1) * ... * (hi - 1)
+            linear_prefix_prod(RF[hi - 1], int64_t(hi - 1), -1,
+                std::span(RF).subspan(lo, hi - lo - 1) | std::views::reverse, hi - lo - 1);
+            for(size_t i = std::max<size_t>(lo, 1); i < hi; i++) {
+                I[i] = RF[i] * F[i - 1];
             }
-            init = true;
         }
-        return F[n];
+
+        T fact(size_t n) {
+            if constexpr (modint_type<T>) {
+                if(n > limit()) {
+                    return T(0);
+                }
+            }
+            grow_fact(n);
+            return F[n];
+        }
+        T rfact(size_t n) {
+            if constexpr (modint_type<T>) {
+                if(n > limit()) {
+                    return T(0);
+                }
+            }
+            grow_rfact(n);
+            return RF[n];
+        }
+        T inv(size_t n) {
+            grow_rfact(n);
+            return I[n];
+        }
+    };
+
+    template<typename T>
+    T fact(auto n) {
+        return fact_table<T>::get().fact(n);
+    }
+    // Only works for modint types
+    template<typename T>
+    T rfact(auto n) {
+        return fact_table<T>::get().rfact(n);
     }
     template<typename T, int base>
     T pow_fixed(int n) {
-        static std::vector<T> prec_low(1 << 16);
-        static std::vector<T> prec_high(1 << 16);
-        static bool init = false;
-        if(!init) {
-            init = true;
-            prec_low[0] = prec_high[0] = T(1);
-            T step_low = T(base);
-            T step_high = bpow(T(base), 1 << 16);
-            for(int i = 1; i < (1 << 16); i++) {
-                prec_low[i] = prec_low[i - 1] * step_low;
-                prec_high[i] = prec_high[i - 1] * step_high;
+        struct tables {
+            std::vector<T> prec_low, prec_high;
+            tables(): prec_low(1 << 16), prec_high(1 << 16) {
+                prec_low[0] = prec_high[0] = T(1);
+                T step_low = T(base);
+                T step_high = bpow(T(base), 1 << 16);
+                for(int i = 1; i < (1 << 16); i++) {
+                    prec_low[i] = prec_low[i - 1] * step_low;
+                    prec_high[i] = prec_high[i - 1] * step_high;
+                }
             }
-        }
+        };
+        auto const& [prec_low, prec_high] = mod_cached<T, tables>();
         return prec_low[n & 0xFFFF] * prec_high[n >> 16];
     }
+    // res[i] = 1 / args[i], all args must be invertible
+    // For small odd moduli, runs 32 interleaved prefix product chains
+    // in u32x8 Montgomery arithmetic, so that only 32 scalar inversions
+    // (done as one) are needed and multiplications do not wait on each other
     template<typename T>
-    std::vector<T> bulk_invs(auto const& args) {
-        std::vector<T> res(std::size(args), args[0]);
-        for(size_t i = 1; i < std::size(args); i++) {
+    [[gnu::target("avx2")]] std::vector<T> bulk_invs(auto const& args) {
+        const size_t n = std::size(args);
+        std::vector<T> res(n);
+        size_t done = 0;
+        if constexpr (modint_type<T>) {
+            if(T::bits <= 32 && T::mod() % 2 && T::mod() < (1 << 30) && n >= 256) {
+                constexpr size_t accum = 4;
+                constexpr size_t simd_size = 8;
+                constexpr size_t width = accum * simd_size;
+                const size_t blocks = n / width;
+                done = blocks * width;
+                const uint32_t mod = uint32_t(T::mod());
+                const uint32_t imod = -inv2(mod);
+                auto load = [&](size_t b, size_t z) {
+                    u32x8 x;
+                    for(size_t j = 0; j < simd_size; j++) {
+                        x[j] = uint32_t(T(args[b * width + z * simd_size + j]).getr());
+                    }
+                    return x;
+                };
+                // Until the backward pass, res[b] holds raw
+                // prod_{t < b} x[t] * R^{1-b} of each chain
+                auto pref = [&](size_t b, size_t z) {
+                    return std::span(res).subspan(b * width + z * simd_size, simd_size);
+                };
+                u32x8 acc[accum];
+                for(size_t z = 0; z < accum; z++) {
+                    acc[z] = u32x8() + uint32_t((uint64_t(1) << 32) % mod);
+                }
+                for(size_t b = 0; b < blocks; b++) {
+                    for(size_t z = 0; z < accum; z++) {
+                        for(size_t j = 0; j < simd_size; j++) {
+                            pref(b, z)[j].setr_direct(typename T::UInt(acc[z][j]));
+                        }
+                        acc[z] = montgomery_mul(acc[z], load(b, z), mod, imod);
+                    }
+                }
+                std::vector<T> totals(width);
+                for(size_t z = 0; z < accum; z++) {
+                    for(size_t j = 0; j < simd_size; j++) {
+                        totals[z * simd_size + j] = T(acc[z][j] % mod);
+                    }
+                }
+                // 1 / (prod x * R^{1-blocks}), the R powers cancel out
+                totals = bulk_invs<T>(totals);
+                for(size_t z = 0; z < accum; z++) {
+                    for(size_t j = 0; j < simd_size; j++) {
+                        acc[z][j] = uint32_t(totals[z * simd_size + j].getr());
+                    }
+                }
+                for(size_t b = blocks; b-- > 0;) {
+                    for(size_t z = 0; z < accum; z++) {
+                        u32x8 x = load(b, z), p;
+                        for(size_t j = 0; j < simd_size; j++) {
+                            p[j] = uint32_t(pref(b, z)[j].getr_direct());
+                        }
+                        auto v = montgomery_mul(acc[z], p, mod, imod);
+                        v = v >= mod ? v - mod : v;
+                        acc[z] = montgomery_mul(acc[z], x, mod, imod);
+                        for(size_t j = 0; j < simd_size; j++) {
+                            res[b * width + z * simd_size + j].setr(typename T::UInt(v[j]));
+                        }
+                    }
+                }
+            }
+        }
+        if(done == n) {
+            return res;
+        }
+        res[done] = args[done];
+        for(size_t i = done + 1; i < n; i++) {
             res[i] = res[i - 1] * args[i];
         }
         auto all_invs = T(1) / res.back();
-        for(size_t i = std::size(args) - 1; i > 0; i--) {
+        for(size_t i = n - 1; i > done; i--) {
             res[i] = all_invs * res[i - 1];
             all_invs *= args[i];
         }
-        res[0] = all_invs;
+        res[done] = all_invs;
         return res;
     }
     template<typename T>
     T small_inv(auto n) {
-        static auto F = bulk_invs<T>(std::views::iota(1, maxn));
-        return F[n - 1];
+        return fact_table<T>::get().inv(n);
     }
     template<typename T>
     T binom_large(T n, auto r) {
-        assert(r < maxn);
         T ans = 1;
         for(decltype(r) i = 0; i < r; i++) {
             ans = ans * T(n - i) * small_inv<T>(i + 1);
@@ -2,98 +2,281 @@
 #define CP_ALGO_MATH_FACTORIALS_HPP
 #include "cp-algo/util/checkpoint.hpp"
 #include "cp-algo/util/bump_alloc.hpp"
+#include "cp-algo/util/parallel.hpp"
 #include "cp-algo/util/simd.hpp"
 #include "cp-algo/math/combinatorics.hpp"
+#include "cp-algo/math/poly.hpp"
 #include "cp-algo/number_theory/modint.hpp"
+#include <numeric>
 #include <ranges>
+#include <bit>
+#include <span>
 
 namespace cp_algo::math {
+    // Holds the query buckets of facts(), keep it around
+    // to reuse their storage between calls
     template<bool use_bump_alloc = false, int maxn = -1>
-    auto facts(auto const& args) {
+    struct facts_context {
         static_assert(!use_bump_alloc || maxn > 0, "maxn must be set if use_bump_alloc is true");
-        constexpr int max_mod = 1'000'000'000;
-        constexpr int accum = 4;
-        constexpr int simd_size = 8;
-        constexpr int block = 1 << 18;
-        constexpr int subblock = block / simd_size;
-        using base = std::decay_t<decltype(args[0])>;
-        static_assert(modint_type<base>, "Base type must be a modint type");
+        static constexpr int max_mod = 1'000'000'000;
+        static constexpr int accum = 4;
+        static constexpr int simd_size = 8;
+        static constexpr int block = 1 << 18;
+        static constexpr int subblock = block / simd_size;
+        static constexpr int limit_reg = max_mod / 64;
+        // {slot, position}, see facts()
         using T = std::array<int, 2>;
         using alloc = std::conditional_t<use_bump_alloc,
             bump_alloc<T, 30 * maxn>,
             big_alloc<T>>;
-        std::basic_string<T, std::char_traits<T>, alloc> odd_args_per_block[max_mod / subblock];
-        std::basic_string<T, std::char_traits<T>, alloc> reg_args_per_block[max_mod / subblock];
-        constexpr int limit_reg = max_mod / 64;
-        int limit_odd = 0;
+        using bucket = std::basic_string<T, std::char_traits<T>, alloc>;
+        std::vector<bucket> odd_args_per_block, reg_args_per_block;
+        std::vector<int, big_alloc<int>> slots;
+
+        facts_context():
+            odd_args_per_block(max_mod / subblock),
+            reg_args_per_block(max_mod / subblock) {}
 
-        std::vector<base, big_alloc<base>> res(size(args), 1);
-        const int mod = base::mod();
-        const int imod = -math::inv2(mod);
-        for(auto [i, xy]: std::views::zip(args, res) | std::views::enumerate) {
-            auto [x, y] = xy;
-            int t = x.getr();
-            if(t >= mod / 2) {
-                t = mod - t - 1;
-                y = t % 2 ? 1 : mod-1;
+        // Each query t is split into O(log) positions to be looked up
+        // in block sweeps. The products found there are stored in vals
+        // at consecutive slots [slots[i], slots[i + 1]) of the i-th query.
+        // Blocks are split between threads, each thread sweeps its range
+        // starting with 1, then the slots are fixed by the prefix products
+        // of preceding ranges.
+        auto facts(auto const& args) {
+            using base = std::decay_t<decltype(args[0])>;
+            static_assert(modint_type<base>, "Base type must be a modint type");
+            for(auto &it: odd_args_per_block) {
+                it.clear();
             }
-            auto pw = 32ull * (t + 1);
-            while(t > limit_reg) {
-                limit_odd = std::max(limit_odd, (t - 1) / 2);
-                odd_args_per_block[(t - 1) / 2 / subblock].push_back({int(i), (t - 1) / 2});
-                t /= 2;
-                pw += t;
+            for(auto &it: reg_args_per_block) {
+                it.clear();
             }
-            reg_args_per_block[t / subblock].push_back({int(i), t});
-            y *= pow_fixed<base, 2>(int(pw % (mod - 1)));
-        }
-        checkpoint("init");
-        base bi2x32 = pow_fixed<base, 2>(32).inv();
-        auto process = [&](int limit, auto &args_per_block, auto step, auto &&proj) {
-            base fact = 1;
-            for(int b = 0; b <= limit; b += accum * block) {
-                u32x8 cur[accum];
-                static std::array<u32x8, subblock> prods[accum];
-                for(int z = 0; z < accum; z++) {
-                    for(int j = 0; j < simd_size; j++) {
+            int limit_odd = 0;
+            const int n = int(std::size(args));
+            const int mod = base::mod();
+            const int imod = -math::inv2(mod);
+            auto reduce = [&](int t) {
+                return t >= mod / 2 ? mod - t - 1 : t;
+            };
+            slots.assign(n + 1, 0);
+            int slot = 0;
+            for(int i = 0; i < n; i++) {
+                slots[i] = slot;
+                int t = reduce(int(args[i].getr()));
+                while(t > limit_reg) {
+                    limit_odd = std::max(limit_odd, (t - 1) / 2);
+                    odd_args_per_block[(t - 1) / 2 / subblock].push_back({slot++, (t - 1) / 2});
+                    t /= 2;
+                }
+                reg_args_per_block[t / subblock].push_back({slot++, t});
+            }
+            slots[n] = slot;
+            std::vector<base, big_alloc<base>> vals(slot);
+            checkpoint("init");
+            const uint32_t bi2x32 = pow_fixed<base, 2>(32).inv().getr();
+            auto process = [&](int limit, auto &args_per_block, auto step, auto &&proj) {
+                int blocks = limit / (accum * block) + 1;
+                size_t threads = std::min<size_t>(num_threads(), blocks);
+                std::vector<base> totals(threads, 1);
+                parallel_for(blocks, [&](size_t th, size_t l, size_t r) {
+                    set_mod<base>(mod);
+                    std::vector<std::array<u32x8, subblock>, big_alloc<std::array<u32x8, subblock>>> prods(accum);
+                    base fact = 1;
+                    for(int b = int(l) * accum * block; b < int(r) * accum * block; b += accum * block) {
+                        u32x8 cur[accum];
+                        for(int z = 0; z < accum; z++) {
+                            for(int j = 0; j < simd_size; j++) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-                        cur[z][j] = uint32_t(b + z * block + j * subblock);
-                        cur[z][j] = proj(cur[z][j]);
-                        prods[z][0][j] = cur[z][j] + !cur[z][j];
-                        prods[z][0][j] = uint32_t(uint64_t(prods[z][0][j]) * bi2x32.getr() % mod);
+                                cur[z][j] = uint32_t(b + z * block + j * subblock);
+                                cur[z][j] = proj(cur[z][j]);
+                                prods[z][0][j] = cur[z][j] + !cur[z][j];
+                                prods[z][0][j] = uint32_t(uint64_t(prods[z][0][j]) * bi2x32 % mod);
 #pragma GCC diagnostic pop
+                            }
+                        }
+                        for(int i = 1; i < block / simd_size; i++) {
+                            for(int z = 0; z < accum; z++) {
+                                cur[z] += step;
+                                prods[z][i] = montgomery_mul(prods[z][i - 1], cur[z], mod, imod);
+                            }
+                        }
+                        for(int z = 0; z < accum; z++) {
+                            for(int j = 0; j < simd_size; j++) {
+                                int bl = b + z * block + j * subblock;
+                                for(auto [i, x]: args_per_block[bl / subblock]) {
+                                    vals[i] = fact * prods[z][x - bl][j];
+                                }
+                                fact *= base(prods[z].back()[j]);
+                            }
+                        }
                     }
+                    totals[th] = fact;
+                }, threads);
+                std::exclusive_scan(begin(totals), end(totals), begin(totals), base(1), std::multiplies{});
+                parallel_for(blocks, [&](size_t th, size_t l, size_t r) {
+                    if(th == 0) {
+                        return;
+                    }
+                    set_mod<base>(mod);
+                    for(size_t bl = l * accum * block / subblock; bl < r * accum * block / subblock; bl++) {
+                        for(auto [i, x]: args_per_block[bl]) {
+                            vals[i] *= totals[th];
+                        }
+                    }
+                }, threads);
+            };
+            process(limit_reg, reg_args_per_block, 1, std::identity{});
+            process(limit_odd, odd_args_per_block, 2, [](uint32_t x) {return 2 * x + 1;});
+            checkpoint("sweep");
+            std::vector<base, big_alloc<base>> res(n);
+            parallel_for(n, [&](size_t, size_t l, size_t r) {
+                set_mod<base>(mod);
+                for(size_t i = l; i < r; i++) {
+                    int t = int(args[i].getr());
+                    base y = 1;
+                    if(t >= mod / 2) {
+                        t = mod - t - 1;
+                        y = t % 2 ? 1 : mod - 1;
+                    }
+                    auto pw = 32ull * (t + 1);
+                    while(t > limit_reg) {
+                        t /= 2;
+                        pw += t;
+                    }
+                    y *= pow_fixed<base, 2>(int(pw % (mod - 1)));
+                    for(int s = slots[i]; s < slots[i + 1]; s++) {
+                        y *= vals[s];
+                    }
+                    res[i] = y;
+                }
+            });
+            checkpoint("mul ans");
+            std::vector<base> large;
+            for(int i = 0; i < n; i++) {
+                if(args[i] >= mod / 2) {
+                    large.push_back(res[i]);
                 }
-                for(int i = 1; i < block / simd_size; i++) {
-                    for(int z = 0; z < accum; z++) {
-                        cur[z] += step;
-                        prods[z][i] = montgomery_mul(prods[z][i - 1], cur[z], mod, imod);
+            }
+            if(!large.empty()) {
+                auto invs = bulk_invs<base>(large);
+                for(int i = 0, j = 0; i < n; i++) {
+                    if(args[i] >= mod / 2) {
+                        res[i] = invs[j++];
                     }
                 }
-                checkpoint("inner loop");
-                for(int z = 0; z < accum; z++) {
-                    for(int j = 0; j < simd_size; j++) {
-                        int bl = b + z * block + j * subblock;
-                        for(auto [i, x]: args_per_block[bl / subblock]) {
-                            res[i] *= fact * prods[z][x - bl][j];
+            }
+            checkpoint("inv ans");
+            return res;
+        }
+
+        // res[k][i] = args[i]! mod mods[k] for each modulus
+        // Moduli must be primes below max_mod, buckets are shared between them
+        auto facts(std::span<uint32_t const> args, std::span<uint32_t const> mods) {
+            using base = dynamic_modint<>;
+            std::vector<std::vector<uint32_t>> res;
+            for(auto m: mods) {
+                res.push_back(base::with_mod(int(m), [&]() {
+                    std::vector<base, big_alloc<base>> margs;
+                    std::vector<size_t> idx;
+                    for(auto [i, x]: std::views::enumerate(args)) {
+                        if(x < m) {
+                            margs.push_back(x);
+                            idx.push_back(i);
                         }
-                        fact *= base(prods[z].back()[j]);
                     }
-                }
-                checkpoint("mul ans");
+                    std::vector<uint32_t> ans(size(args));
+                    for(auto [i, x]: std::views::zip(idx, facts(margs))) {
+                        ans[i] = x.getr();
+                    }
+                    return ans;
+                }));
             }
+            return res;
+        }
+    };
+
+    template<bool use_bump_alloc = false, int maxn = -1>
+    auto facts(auto const& args) {
+        return facts_context<use_bump_alloc, maxn>().facts(args);
+    }
+
+    // prod_{1 <= i <= n} (a * i + b) in O(sqrt(n) log n) for prime modulus
+    // With v = isqrt(n) and g_d(x) = prod_{1 <= i <= d} (a(vx + i) + b),
+    // the values g_d(0..d) are doubled into g_{2d}(0..2d) via
+    // g_{2d}(x) = g_d(x) g_d(x + d/v) and shift_samples, then
+    // the product of g_v(0..v-1) covers i <= v^2 and the rest is naive
+    template<modint_type base>
+    base prod_linear(base a, base b, uint64_t n) {
+        const uint64_t mod = base::mod();
+        if(a == base(0)) {
+            return bpow(b, n);
+        }
+        if(n >= mod) {
+            // a * i + b hits zero on any mod consecutive i
+            return base(0);
+        }
+        if(n >= mod / 2) {
+            // Terms with i from r + 1 - mod to r - 1, where a * r + b = 0,
+            // run over a * t for t = 1..mod-1 and multiply to -1
+            uint64_t r = (-b / a).getr();
+            if(r >= 1 && r <= n) {
+                return base(0);
+            }
+            auto range = [&](uint64_t l, uint64_t r) {
+                return prod_linear(a, a * base(l - 1) + b, r + 1 - l);
+            };
+            auto rest = r ? range(n + 1, r - 1) * range(r + 1, mod) : range(n + 1, mod - 1);
+            return -rest.inv();
+        }
+        auto naive = [&](uint64_t l, uint64_t r) {
+            base res = 1;
+            for(uint64_t i = l; i <= r; i++) {
+                res *= a * base(i) + b;
+            }
+            return res;
         };
-        process(limit_reg, reg_args_per_block, 1, std::identity{});
-        process(limit_odd, odd_args_per_block, 2, [](uint32_t x) {return 2 * x + 1;});
-        auto invs = bulk_invs<base>(res);
-        for(auto [i, x]: res | std::views::enumerate) {
-            if (args[i] >= mod / 2) {
-                x = invs[i];
+        if(n < (1 << 12)) {
+            return naive(1, n);
+        }
+        using polyn = poly_t<base>;
+        uint64_t v = 1;
+        while((v + 1) * (v + 1) <= n) {
+            v++;
+        }
+        auto iv = base(v).inv();
+        typename polyn::Vector G = {a + b, a * base(v + 1) + b};
+        uint64_t d = 1;
+        for(int k = int(std::bit_width(v)) - 2; k >= 0; k--) {
+            // g_d(d+1..2d) and g_d(d/v + 0..2d)
+            auto Gr = polyn::shift_samples(G, base(d + 1), d);
+            auto S = polyn::shift_samples(G, base(d) * iv, 2 * d + 1);
+            G.insert(end(G), begin(Gr), end(Gr));
+            for(size_t x = 0; x <= 2 * d; x++) {
+                G[x] *= S[x];
+            }
+            d *= 2;
+            if(v >> k & 1) {
+                // g_{d+1}(x) = g_d(x) (a(vx + d + 1) + b)
+                for(size_t x = 0; x <= d; x++) {
+                    G[x] *= a * base(v * x + d + 1) + b;
+                }
+                d++;
+                base last = 1;
+                for(uint64_t i = 1; i <= d; i++) {
+                    last *= a * base(v * d + i) + b;
+                }
+                G.push_back(last);
             }
         }
-        checkpoint("inv ans");
-        return res;
+        G.pop_back();
+        return std::accumulate(begin(G), end(G), base(1), std::multiplies{}) * naive(v * v + 1, n);
+    }
+    // n! mod p in O(sqrt(p) log p) for prime modulus
+    template<modint_type base>
+    base fact_large(uint64_t n) {
+        return prod_linear(base(1), base(0), n);
     }
 }
 #endif // CP_ALGO_MATH_FACTORIALS_HPP
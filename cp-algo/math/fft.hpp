@@ -123,9 +123,10 @@ namespace cp_algo::math::fft {
             dot(C, D, A, B, C);
         }
 
-        void recover_mod(auto &&C, auto &res, size_t k) {
+        // writes coefficients [from, k) of the product to res[0, k - from)
+        void recover_mod(auto &&C, auto &res, size_t k, size_t from = 0) {
             size_t check = (k + flen - 1) / flen * flen;
-            assert(res.size() >= check);
+            assert(res.size() + from >= check);
             size_t n = A.size();
             auto const splitsplit = base(split() * split()).getr();
             base b2x32 = bpow(base(2), 32);
@@ -143,13 +144,18 @@ namespace cp_algo::math::fft {
                 auto [Bx, By] = B.at(i);
                 auto [Cx, Cy] = C.at(i);
                 auto set_i = [&](size_t i, auto A, auto B, auto C, auto mul) {
+                    if(i + flen <= from) {
+                        return;
+                    }
                     auto A0 = lround(A), A1 = lround(C), A2 = lround(B);
                     auto Ai = A0 + A1 * split() + A2 * splitsplit + uint64_t(base::modmod());
                     auto Au = montgomery_reduce(u64x4(Ai), mod, imod);
                     Au = montgomery_mul(Au, mul, mod, imod);
                     Au = Au >= base::mod() ? Au - base::mod() : Au;
                     for(size_t j = 0; j < flen; j++) {
-                        res[i + j].setr(typename base::UInt(Au[j]));
+                        if(i + j >= from) {
+                            res[i + j - from].setr(typename base::UInt(Au[j]));
+                        }
                     }
                 };
                 set_i(i, Ax, Bx, Cx, cur);
@@ -161,7 +167,7 @@ namespace cp_algo::math::fft {
             checkpoint("recover mod");
         }
 
-        void mul(auto &&C, auto const& D, auto &res, size_t k) {
+        void mul(auto &&C, auto const& D, auto &res, size_t k, size_t from = 0) {
             assert(A.size() == C.size());
             size_t n = A.size();
             if(!n) {
@@ -172,13 +178,13 @@ namespace cp_algo::math::fft {
             A.ifft();
             B.ifft();
             C.ifft();
-            recover_mod(C, res, k);
+            recover_mod(C, res, k, from);
         }
-        void mul_inplace(auto &&B, auto& res, size_t k) {
-            mul(B.A, B.B, res, k);
+        void mul_inplace(auto &&B, auto& res, size_t k, size_t from = 0) {
+            mul(B.A, B.B, res, k, from);
         }
-        void mul(auto const& B, auto& res, size_t k) {
-            mul(cvector(B.A), B.B, res, k);
+        void mul(auto const& B, auto& res, size_t k, size_t from = 0) {
+            mul(cvector(B.A), B.B, res, k, from);
         }
         std::vector<base, big_alloc<base>> operator *= (dft &B) {
             std::vector<base, big_alloc<base>> res(2 * A.size());
@@ -239,6 +245,35 @@ namespace cp_algo::math::fft {
         a.resize(k);
     }
 
+    // res[t] = sum_i a[i + t] * b[i] for t in [0, k), a is zero-padded
+    // Only needs a cyclic product of size max(|a|, |b| + k - 1), as
+    // wrapped-around terms land below |b| - 1 and are discarded
+    // res may alias a
+    void semicorr(auto const& a, auto const& b, auto &res, size_t k) {
+        using base = std::decay_t<decltype(b[0])>;
+        size_t n = std::size(a), m = std::size(b);
+        if(!k || !n || !m) {
+            res.assign(k, base(0));
+            return;
+        }
+        if(std::min(k, m) < magic) {
+            std::vector<base, big_alloc<base>> tmp(k);
+            for(size_t t = 0; t < k && t < n; t++) {
+                for(size_t i = 0; i < m && i + t < n; i++) {
+                    tmp[t] += a[i + t] * b[i];
+                }
+            }
+            res.assign(begin(tmp), end(tmp));
+            return;
+        }
+        auto N = std::max(flen, std::bit_ceil(std::max(n, m + k - 1)) / 2);
+        auto A = dft<base>(a, N);
+        auto B = dft<base>(b | std::views::reverse, N);
+        res.resize((m + k - 1 + flen - 1) / flen * flen - (m - 1));
+        A.mul_inplace(B, res, m + k - 1, m - 1);
+        res.resize(k);
+    }
+
     // store mod x^n-k in first half, x^n+k in second half
     void mod_split(auto &&x, size_t n, auto k) {
         using base = std::decay_t<decltype(k)>;
@@ -3,12 +3,14 @@
 #include "poly/impl/euclid.hpp"
 #include "poly/impl/div.hpp"
 #include "combinatorics.hpp"
+#include "../number_theory/modint_ops.hpp"
 #include "../number_theory/discrete_sqrt.hpp"
 #include "fft.hpp"
 #include <functional>
 #include <algorithm>
 #include <iostream>
 #include <optional>
+#include <numeric>
 #include <utility>
 #include <vector>
 #include <list>
@@ -83,9 +85,7 @@ namespace cp_algo::math {
         poly_t operator % (poly_t const& t) const {return poly_t(*this) %= t;}
 
         poly_t& operator *= (T const& x) {
-            for(auto &it: a) {
-                it *= x;
-            }
+            mul_inplace<T>(a, x);
             return normalize();
         }
         poly_t& operator /= (T const& x) {return *this *= x.inv();}
@@ -150,12 +150,7 @@ namespace cp_algo::math {
         }
         
         T eval(T x) const { // evaluates in single point x
-            T res(0);
-            for(int i = deg(); i >= 0; i--) {
-                res *= x;
-                res += a[i];
-            }
-            return res;
+            return math::eval<T>(a, x);
         }
         
         T lead() const { // leading coefficient
@@ -186,10 +181,14 @@ namespace cp_algo::math {
             if(deg() + 1 < k) {
                 return *this = poly_t{};
             }
-            for(int i = k; i <= deg(); i++) {
-                a[i - k] = fact<T>(i) * rfact<T>(i - k) * a[i];
+            a.erase(begin(a), begin(a) + k);
+            if(k > 0 && !a.empty()) {
+                // a[i] *= (i+k)! / i!
+                auto &tbl = fact_table<T>::get();
+                tbl.grow_rfact(size(a) + k - 1);
+                mul_inplace<T>(a, std::span(tbl.F).subspan(k, size(a)));
+                mul_inplace<T>(a, std::span(tbl.RF).first(size(a)));
             }
-            a.resize(deg() + 1 - k);
             return *this;
         }
         poly_t deriv(int k = 1) const { // calculate derivative
@@ -197,18 +196,18 @@ namespace cp_algo::math {
         }
 
         poly_t& integr_inplace() {
-            a.push_back(0);
-            for(int i = deg() - 1; i >= 0; i--) {
-                a[i + 1] = a[i] * small_inv<T>(i + 1);
-            }
-            a[0] = 0;
+            a.insert(begin(a), T(0));
+            auto &tbl = fact_table<T>::get();
+            tbl.grow_rfact(size(a) - 1);
+            mul_inplace<T>(std::span(a).subspan(1), std::span(tbl.I).subspan(1, size(a) - 1));
             return *this;
         }
         poly_t integr() const { // calculate integral with C = 0
             Vector res(deg() + 2);
-            for(int i = 0; i <= deg(); i++) {
-                res[i + 1] = a[i] * small_inv<T>(i + 1);
-            }
+            std::ranges::copy(a, begin(res) + 1);
+            auto &tbl = fact_table<T>::get();
+            tbl.grow_rfact(size(a));
+            mul_inplace<T>(std::span(res).subspan(1), std::span(tbl.I).subspan(1, size(a)));
             return res;
         }
         
@@ -366,12 +365,8 @@ namespace cp_algo::math {
         }
         
         poly_t mulx(T a) const { // component-wise multiplication with a^k
-            T cur = 1;
             poly_t res(*this);
-            for(int i = 0; i <= deg(); i++) {
-                res.coef(i) *= cur;
-                cur *= a;
-            }
+            mul_pows_inplace<T>(res.a, a);
             return res;
         }
 
@@ -386,22 +381,47 @@ namespace cp_algo::math {
             return res;
         }
 
-        // be mindful of maxn, as the function
-        // requires multiplying polynomials of size deg() and n+deg()!
-        poly_t chirpz(T z, int n) const { // P(1), P(z), P(z^2), ..., P(z^(n-1))
+        static Vector pow_sq(T z, size_t n) { // z^{k choose 2} for k < n
+            Vector res(n);
+            T cur = 1, total = 1;
+            for(size_t i = 0; i < n; i++) {
+                res[i] = total;
+                total *= cur;
+                cur *= z;
+            }
+            return res;
+        }
+
+        // Writes P(1), P(z), P(z^2), ..., P(z^(n-1)) to res
+        // Uses z^{ij} = z^{(i+j) choose 2} / (z^{i choose 2} z^{j choose 2}),
+        // so that only the middle product of size n+deg() is needed
+        void chirpz(T z, size_t n, Vector &res) const {
             if(is_zero()) {
-                return Vector(n, 0);
+                res.assign(n, T(0));
+                return;
             }
             if(z == T(0)) {
-                Vector ans(n, (*this)[0]);
+                res.assign(n, (*this)[0]);
                 if(n > 0) {
-                    ans[0] = accumulate(begin(a), end(a), T(0));
+                    res[0] = accumulate(begin(a), end(a), T(0));
                 }
-                return ans;
+                return;
+            }
+            auto izsq = pow_sq(z.inv(), std::max(n, a.size()));
+            Vector A(a.size());
+            for(size_t i = 0; i < a.size(); i++) {
+                A[i] = a[i] * izsq[i];
+            }
+            res = pow_sq(z, n + deg());
+            fft::semicorr(res, A, res, n);
+            for(size_t i = 0; i < n; i++) {
+                res[i] *= izsq[i];
             }
-            auto A = mulx_sq(z.inv());
-            auto B = ones(n+deg()).mulx_sq(z);
-            return semicorr(B, A).mod_xk(n).mulx_sq(z.inv());
+        }
+        poly_t chirpz(T z, int n) const { // P(1), P(z), P(z^2), ..., P(z^(n-1))
+            Vector res;
+            chirpz(z, n, res);
+            return res;
         }
 
         // res[i] = prod_{1 <= j <= i} 1/(1 - z^j)
@@ -598,10 +618,55 @@ namespace cp_algo::math {
             return res;
         }
         
-        poly_t shift(T a) const { // P(x + a)
-            return semicorr(invborel(), expx(deg() + 1).mulx(a)).borel();
+        poly_t shift(T c) const { // P(x + c)
+            size_t n = a.size();
+            Vector A(n), E(n);
+            T cur = 1;
+            for(size_t i = 0; i < n; i++) {
+                A[i] = a[i] * fact<T>(i);
+                E[i] = cur * rfact<T>(i);
+                cur *= c;
+            }
+            fft::semicorr(A, E, A, n);
+            for(size_t i = 0; i < n; i++) {
+                A[i] *= rfact<T>(i);
+            }
+            return A;
         }
-        
+
+        // Given P(0), ..., P(d) of deg P <= d, returns P(c), ..., P(c+k-1)
+        // Requires c + j - i != 0 for all 0 <= i <= d and 0 <= j < k
+        // P(c+j) = prod_i (c+j-i) * sum_i P(i) w_i / (c+j-i),
+        // where w_i = (-1)^{d-i} / (i! (d-i)!), so it is a middle product
+        static Vector shift_samples(Vector const& y, T c, size_t k) {
+            if(y.empty() || !k) {
+                return Vector(k);
+            }
+            size_t d = y.size() - 1;
+            Vector W(d + 1), X(d + k);
+            for(size_t i = 0; i <= d; i++) {
+                W[d - i] = y[i] * rfact<T>(i) * rfact<T>(d - i);
+                if((d - i) % 2) {
+                    W[d - i] = -W[d - i];
+                }
+            }
+            for(size_t s = 0; s < d + k; s++) {
+                X[s] = c - T(d) + T(s);
+            }
+            auto iX = bulk_invs<T>(X);
+            Vector res(k);
+            res[0] = std::accumulate(begin(X), begin(X) + d + 1, T(1), std::multiplies{});
+            for(size_t j = 1; j < k; j++) {
+                res[j] = res[j - 1] * X[j + d] * iX[j - 1];
+            }
+            X.assign(begin(iX), end(iX));
+            fft::semicorr(X, W, X, k);
+            for(size_t j = 0; j < k; j++) {
+                res[j] *= X[j];
+            }
+            return res;
+        }
+
         poly_t x2() { // P(x) -> P(x^2)
             Vector res(2 * a.size());
             for(size_t i = 0; i < a.size(); i++) {
@@ -71,6 +71,10 @@ namespace cp_algo::math::poly::impl {
             for(int c = M->deg(); 2 * c <= s; M++) {
                 c += next(M)->deg();
             }
+            // The first quotient alone may have more than half of the degree
+            if(M == L) {
+                M++;
+            }
             return convergent(L, M) * convergent(M, R);
         }
     }
@@ -83,7 +87,8 @@ namespace cp_algo::math::poly::impl {
         auto [a, Tr] = full_gcd(R1, R2);
         a.emplace_back();
         auto pref = begin(a);
-        for(int delta = (int)d - a.front().deg(); delta >= 0; pref++) {
+        // All quotients are taken if the fraction ends early
+        for(int delta = (int)d - a.front().deg(); delta >= 0 && next(pref) != end(a); pref++) {
             delta -= pref->deg() + next(pref)->deg();
         }
         return convergent(begin(a), pref).a;
@@ -1,14 +1,163 @@
 #ifndef CP_ALGO_NUMBER_THEORY_DISCRETE_LOG_HPP
 #define CP_ALGO_NUMBER_THEORY_DISCRETE_LOG_HPP
 #include "euler.hpp"
+#include <algorithm>
 #include <optional>
+#include <vector>
+#include <cmath>
+#include <bit>
 namespace cp_algo::math {
+    namespace impl {
+        // Open addressing table from residues to the smallest exponent
+        struct bsgs_table {
+            static constexpr uint64_t empty = -1;
+            std::vector<uint64_t> keys;
+            std::vector<uint32_t> vals;
+            int shift = 63;
+
+            bsgs_table() = default;
+            bsgs_table(size_t n): keys(std::bit_ceil(std::max<size_t>(2 * n, 2)), empty), vals(size(keys)) {
+                shift = 64 - std::countr_zero(size(keys));
+            }
+            size_t slot(uint64_t key) const {
+                return (key * 0x9E3779B97F4A7C15) >> shift;
+            }
+            void insert(uint64_t key, uint32_t val) {
+                size_t i = slot(key);
+                for(; keys[i] != empty; i = (i + 1) & (size(keys) - 1)) {
+                    if(keys[i] == key) {
+                        return;
+                    }
+                }
+                keys[i] = key;
+                vals[i] = val;
+            }
+            std::optional<uint32_t> find(uint64_t key) const {
+                for(size_t i = slot(key); keys[i] != empty; i = (i + 1) & (size(keys) - 1)) {
+                    if(keys[i] == key) {
+                        return vals[i];
+                    }
+                }
+                return std::nullopt;
+            }
+        };
+    }
+
+    // Logarithms to a fixed base b coprime to m, reused between queries
+    // With n = period(b), the log is found modulo each q^e in n digit by digit
+    // in the subgroup of order q (Pohlig-Hellman), then combined by CRT.
+    // The subgroup logs are baby-step giant-step with sqrt(q * queries) baby steps,
+    // so that building the tables and answering the queries take about the same time.
+    template<typename _Int>
+    struct discrete_log_context {
+        using Int = std::make_signed_t<_Int>;
+        using base = dynamic_modint<Int>;
+        struct prime_part {
+            Int q, qe, crt;
+            int e;
+            // b^{n/q^e} of order q^e and its inverse
+            base bq, bq_inv;
+            // gamma = b^{n/q} of order q, table of gamma^j for j < steps,
+            // and gamma^{-steps} to make a giant step
+            impl::bsgs_table table;
+            Int steps, giants;
+            base giant;
+        };
+        Int m, n = 1;
+        base b;
+        std::vector<prime_part> parts;
+
+        discrete_log_context(_Int b_, _Int m, size_t queries = 1): m(m) {
+            base::with_mod(m, [&]() {
+                b = b_;
+                if(m == 1) {
+                    return;
+                }
+                // n divides the group order, whose primes are known
+                auto const& group = current_group<base>();
+                n = group.period(b);
+                for(auto q: group.primes) {
+                    if(n % q) {
+                        continue;
+                    }
+                    prime_part part;
+                    part.q = q;
+                    part.qe = 1;
+                    part.e = 0;
+                    for(Int t = n; t % q == 0; t /= q) {
+                        part.qe *= q;
+                        part.e++;
+                    }
+                    part.bq = bpow(b, n / part.qe);
+                    part.bq_inv = bpow(part.bq, part.qe - 1);
+                    auto gamma = bpow(part.bq, part.qe / part.q);
+                    part.steps = std::clamp(Int(std::ceil(std::sqrt(double(part.q) * double(queries)))), Int(1), part.q);
+                    part.giants = (part.q + part.steps - 1) / part.steps;
+                    part.table = impl::bsgs_table(part.steps);
+                    base cur = 1;
+                    for(Int j = 0; j < part.steps; j++) {
+                        part.table.insert(cur.getr(), uint32_t(j));
+                        cur *= gamma;
+                    }
+                    part.giant = bpow(gamma, part.q - part.steps % part.q);
+                    // crt = 1 mod q^e and 0 mod n / q^e
+                    Int u = n / part.qe;
+                    Int u_inv = base::with_mod(part.qe, [&]() {
+                        return Int(bpow(base(u), part.qe / part.q * (part.q - 1) - 1).getr());
+                    });
+                    part.crt = Int(__int128_t(u) * u_inv % n);
+                    parts.push_back(std::move(part));
+                }
+            });
+        }
+
+        // Min non-negative x s.t. b^x = c (mod m)
+        std::optional<_Int> log(_Int c) const {
+            return base::with_mod(m, [&]() -> std::optional<_Int> {
+                base cb = c;
+                Int x = 0;
+                for(auto const& part: parts) {
+                    // b_q^{x_q} = c^{n/q^e}, x_q = sum d_k q^k
+                    base cur = bpow(cb, n / part.qe);
+                    Int xq = 0;
+                    for(Int qk = 1, k = 0; k < part.e; k++, qk *= part.q) {
+                        auto d = subgroup_log(part, bpow(cur, part.qe / qk / part.q));
+                        if(!d) {
+                            return std::nullopt;
+                        }
+                        xq += *d * qk;
+                        cur *= bpow(part.bq_inv, *d * qk);
+                    }
+                    x = Int((__int128_t(xq) * part.crt + x) % n);
+                }
+                if(bpow(b, x) != cb) {
+                    return std::nullopt;
+                }
+                return _Int(x);
+            });
+        }
+    private:
+        // d < q s.t. gamma^d = h
+        static std::optional<Int> subgroup_log(prime_part const& part, base h) {
+            for(Int i = 0; i < part.giants; i++) {
+                if(auto j = part.table.find(h.getr())) {
+                    return i * part.steps + Int(*j);
+                }
+                h *= part.giant;
+            }
+            return std::nullopt;
+        }
+    };
+
     // Find min non-negative x s.t. a*b^x = c (mod m)
     template<typename _Int>
     std::optional<_Int> discrete_log(_Int b, _Int c, _Int m, _Int a = 1) {
         if(std::abs(a - c) % m == 0) {
             return 0;
         }
+        if(a == 1 && std::gcd(b, m) == 1) {
+            return discrete_log_context<_Int>(b, m).log(c);
+        }
         if(std::gcd(a, m) != std::gcd(int64_t(a) * b, int64_t(m))) {
             auto res = discrete_log(b, c, m, _Int(int64_t(a) * b % m));
             return res ? std::optional(*res + 1) : res;
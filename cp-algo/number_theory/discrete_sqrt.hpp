@@ -1,29 +1,140 @@
 #ifndef CP_ALGO_NUMBER_THEORY_DISCRETE_SQRT_HPP
 #define CP_ALGO_NUMBER_THEORY_DISCRETE_SQRT_HPP
 #include "modint.hpp"
-#include "../random/rng.hpp"
-#include "../math/affine.hpp"
+#include "modint_ops.hpp"
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <span>
+#include <bit>
 namespace cp_algo::math {
-    // https://en.wikipedia.org/wiki/Berlekamp-Rabin_algorithm
+    // https://en.wikipedia.org/wiki/Tonelli-Shanks_algorithm
+    // For a prime modulus p with p - 1 = 2^s q, the root of a is a^{(q+1)/2} c^{-e/2},
+    // where c = z^q for a non-residue z generates the 2-Sylow subgroup and c^e = a^q.
+    // The exponent e is found w bits at a time by looking up t^{2^{s-k-w}}
+    // among the 2^w-th roots of unity, which takes about s^2/2w multiplications.
+    // Exponents are kept in base::UInt, so this also works for wide_modint
     template<modint_type base>
-    std::optional<base> sqrt(base b) {
-        if(b == base(0)) {
-            return base(0);
-        } else if(bpow(b, (b.mod() - 1) / 2) != base(1)) {
-            return std::nullopt;
-        } else {
-            while(true) {
-                base z = random::rng();
-                if(z * z == b) {
-                    return z;
+    struct sqrt_context {
+        using UInt = base::UInt;
+        UInt q = 0;
+        int s = 0, w = 0;
+        // steps[i][j] = c^{-j 2^{iw}}
+        std::vector<std::vector<base>> steps;
+        // {G^j, j} sorted for G = c^{2^{s-w}} of order 2^w
+        std::vector<std::pair<UInt, UInt>> roots;
+
+        // Larger windows make bigger tables but faster queries
+        sqrt_context(int max_w = 8) {
+            UInt p = UInt(base::mod());
+            if(p == 2) {
+                return;
+            }
+            using std::countr_zero;
+            s = int(countr_zero(p - 1));
+            q = (p - 1) >> s;
+            w = std::min(s, max_w);
+            if(s == 1) {
+                return;
+            }
+            UInt z = 2;
+            while(bpow(base(z), (p - 1) / 2) == base(1)) {
+                z += 1;
+            }
+            base c = bpow(base(z), q);
+            base ci = c.inv();
+            for(int k = 0; k < s; k += w) {
+                auto &row = steps.emplace_back(size_t(1) << w);
+                row[0] = 1;
+                for(size_t j = 1; j < size(row); j++) {
+                    row[j] = row[j - 1] * ci;
+                }
+                for(int i = 0; i < w; i++) {
+                    ci *= ci;
+                }
+            }
+            base G = bpow(c, UInt(1) << (s - w)), cur = 1;
+            for(size_t j = 0; j < (size_t(1) << w); j++) {
+                roots.push_back({cur.getr(), UInt(j)});
+                cur *= G;
+            }
+            std::ranges::sort(roots);
+        }
+
+        std::optional<base> sqrt(base a) const {
+            if(a == base(0) || s == 0) {
+                return a;
+            } else if(s == 1) {
+                // p = 3 mod 4, a^{(p+1)/4} is the root if there is one
+                base x = bpow(a, (q + 1) / 2);
+                return x * x == a ? std::optional(x) : std::nullopt;
+            } else {
+                return finish(a, bpow(a, (q - 1) / 2));
+            }
+        }
+        // res[i] = sqrt(a[i]), a^{(q-1)/2} for all a[i] at once
+        std::vector<std::optional<base>> sqrt(std::span<base const> a) const {
+            std::vector<base> t(begin(a), end(a));
+            UInt k = s == 1 ? (q + 1) / 2 : (q - 1) / 2;
+            if constexpr (base::bits <= 64) {
+                pow_inplace(std::span(t), uint64_t(k));
+            } else {
+                for(auto &it: t) {
+                    it = bpow(it, k);
+                }
+            }
+            std::vector<std::optional<base>> res(size(a));
+            for(size_t i = 0; i < size(a); i++) {
+                if(a[i] == base(0) || s == 0) {
+                    res[i] = a[i];
+                } else if(s == 1) {
+                    res[i] = t[i] * t[i] == a[i] ? std::optional(t[i]) : std::nullopt;
+                } else {
+                    res[i] = finish(a[i], t[i]);
                 }
-                lin<base> x(1, z, b); // x + z (mod x^2 - b)
-                x = bpow(x, (b.mod() - 1) / 2, lin<base>(0, 1, b));
-                if(x.a != base(0)) {
-                    return x.a.inv();
+            }
+            return res;
+        }
+    private:
+        // t0 = a^{(q-1)/2}
+        std::optional<base> finish(base a, base t0) const {
+            base x = a * t0, t = x * t0;
+            // t = a^q = c^e, after the k-th step t = c^{e - (e mod 2^k)}
+            UInt e = 0;
+            for(int k = 0; k < s; k += w) {
+                int wk = std::min(w, s - k);
+                base h = t;
+                for(int i = 0; i < s - k - wk; i++) {
+                    h *= h;
                 }
+                // h = c^{2^{s-wk} d} = G^{2^{w-wk} d}
+                auto it = std::ranges::lower_bound(roots, std::pair{h.getr(), UInt(0)});
+                size_t d = size_t(it->second) >> (w - wk);
+                e += UInt(d) << k;
+                t *= steps[k / w][d];
             }
+            if(e % 2) {
+                return std::nullopt;
+            }
+            e /= 2;
+            for(int k = 0; k < s; k += w) {
+                x *= steps[k / w][size_t(e >> k) & ((size_t(1) << w) - 1)];
+            }
+            return x;
+        }
+    };
+
+    // The context is kept for the last modulus used in the thread
+    template<modint_type base>
+    std::optional<base> sqrt(base b) {
+        thread_local std::optional<sqrt_context<base>> ctx;
+        thread_local typename base::Int last_mod = 0;
+        if(!ctx || last_mod != base::mod()) {
+            last_mod = base::mod();
+            ctx.emplace(4);
         }
+        return ctx->sqrt(b);
     }
 }
 #endif // CP_ALGO_NUMBER_THEORY_SQRT_HPP
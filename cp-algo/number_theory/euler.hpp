@@ -1,10 +1,11 @@
 #ifndef CP_ALGO_NUMBER_THEORY_EULER_HPP
 #define CP_ALGO_NUMBER_THEORY_EULER_HPP
 #include "factorize.hpp"
+#include <optional>
+#include <vector>
 namespace cp_algo::math {
     auto euler_phi(auto m) {
-        auto primes = to<std::vector>(factorize(m));
-        std::ranges::sort(primes);
+        auto primes = factorize_cached(m);
         auto [from, to] = std::ranges::unique(primes);
         primes.erase(from, to);
         auto ans = m;
@@ -13,28 +14,90 @@ namespace cp_algo::math {
         }
         return ans;
     }
-    template<modint_type base>
-    auto period(base x) {
-        auto ans = euler_phi(base::mod());
-        base x0 = bpow(x, ans);
-        for(auto t: factorize(ans)) {
-            while(ans % t == 0 && x0 * bpow(x, ans / t) == x0) {
-                ans /= t;
+    // Units modulo m, the order phi(m) is factorized once
+    // and shared between period and primitive root queries
+    template<typename _Int>
+    struct multiplicative_group {
+        using Int = std::make_signed_t<_Int>;
+        using base = dynamic_modint<Int>;
+        Int m, order;
+        // Prime factors of the order with multiplicity and without
+        std::vector<Int> factors, primes;
+
+        multiplicative_group(_Int m): m(m), order(euler_phi(Int(m))), factors(factorize_cached(order)), primes(factors) {
+            auto [from, to] = std::ranges::unique(primes);
+            primes.erase(from, to);
+        }
+
+        // Min k > 0 s.t. x^{t+k} = x^t for large t, x is taken modulo m
+        template<modint_type T>
+        Int period(T x) const {
+            assert(T::mod() == m);
+            Int ans = order;
+            T x0 = bpow(x, ans);
+            for(auto t: factors) {
+                while(ans % t == 0 && x0 * bpow(x, ans / t) == x0) {
+                    ans /= t;
+                }
             }
+            return ans;
         }
-        return ans;
+        // Whether x^{order/q} != 1 for all prime q | order
+        // With y = x^{order/Q} for Q = prod q, the powers y^{Q/q} are found by
+        // splitting the primes in halves and raising y to the product of the other half
+        template<modint_type T>
+        bool is_generator(T x) const {
+            assert(T::mod() == m);
+            Int Q = 1;
+            for(auto q: primes) {
+                Q *= q;
+            }
+            auto rec = [&](auto &&self, T y, size_t l, size_t r) -> bool {
+                if(r - l == 1) {
+                    return y != T(1);
+                }
+                size_t mid = (l + r) / 2;
+                auto prod = [&](size_t l, size_t r) {
+                    Int res = 1;
+                    for(size_t i = l; i < r; i++) {
+                        res *= primes[i];
+                    }
+                    return res;
+                };
+                return self(self, bpow(y, prod(mid, r)), l, mid)
+                    && self(self, bpow(y, prod(l, mid)), mid, r);
+            };
+            return primes.empty() ? x == T(1) : rec(rec, bpow(x, order / Q), 0, size(primes));
+        }
+        // Smallest primitive root, must exist
+        _Int primitive_root() const {
+            return base::with_mod(m, [&]() {
+                Int g = 1;
+                while(!is_generator(base(g))) {
+                    g++;
+                }
+                return _Int(g);
+            });
+        }
+    };
+
+    // Group for the current modulus of base, kept for the last modulus used in the thread
+    template<modint_type base>
+    auto const& current_group() {
+        using Int = base::Int;
+        thread_local std::optional<multiplicative_group<Int>> group;
+        if(!group || group->m != base::mod()) {
+            group.emplace(base::mod());
+        }
+        return *group;
+    }
+    template<modint_type base>
+    auto period(base x) {
+        return current_group<base>().period(x);
     }
     template<typename _Int>
     _Int primitive_root(_Int p) {
-        using Int = std::make_signed_t<_Int>;
-        using base = dynamic_modint<Int>;
-        return base::with_mod(p, [p](){
-            base t = 1;
-            while(period(t) != p - 1) {
-                t = random::rng();
-            }
-            return t.getr();
-        });
+        return multiplicative_group<_Int>(p).primitive_root();
     }
 }
 #endif // CP_ALGO_NUMBER_THEORY_EULER_HPP
@@ -1,47 +1,229 @@
 #ifndef CP_ALGO_MATH_FACTORIZE_HPP
 #define CP_ALGO_MATH_FACTORIZE_HPP
 #include "primality.hpp"
+#include "sieve.hpp"
+#include "wide_modint.hpp"
 #include "../random/rng.hpp"
-#include <generator>
+#include "../util/parallel.hpp"
+#include "../util/simd.hpp"
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <vector>
+#include <array>
+#include <span>
+#include <list>
+#include <map>
 namespace cp_algo::math {
     // https://en.wikipedia.org/wiki/Pollard%27s_rho_algorithm
+    // Brent's variant: y runs r steps ahead of the saved x for r = 1, 2, 4, ...
+    // and the differences are multiplied into q, taking gcd once per batch.
+    // If the batch overshoots to gcd = m, it is replayed one step at a time.
     template<typename _Int>
     auto proper_divisor(_Int m) {
-        using Int = std::make_signed_t<_Int>;
-        using base = dynamic_modint<Int>;
-        return m % 2 == 0 ? 2 : base::with_mod(m, [&]() {
-            base t = random::rng();
-            auto f = [&](auto x) {
-                return x * x + t;
-            };
-            base x = 0, y = 0;
-            base g = 1;
-            while(g == 1) {
-                for(int i = 0; i < 64; i++) {
-                    x = f(x);
-                    y = f(f(y));
-                    if(x == y) [[unlikely]] {
-                        t = random::rng();
-                        x = y = 0;
-                    } else {
-                        base t = g * (x - y);
-                        g = t == 0 ? g : t;
+        using base = modint_for_t<_Int>;
+        if(m % 2 == 0) {
+            return _Int(2);
+        }
+        return base::with_mod(m, [&]() {
+            using std::gcd;
+            const size_t batch = 256;
+            while(true) {
+                base t = random::rng();
+                auto f = [&](auto x) {
+                    return x * x + t;
+                };
+                base x, y = random::rng(), ys, q = 1;
+                _Int g = 1;
+                for(size_t r = 1; g == 1; r *= 2) {
+                    x = y;
+                    for(size_t i = 0; i < r; i++) {
+                        y = f(y);
+                    }
+                    for(size_t k = 0; k < r && g == 1; k += batch) {
+                        ys = y;
+                        for(size_t i = 0; i < std::min(batch, r - k); i++) {
+                            y = f(y);
+                            q *= x - y;
+                        }
+                        g = gcd(_Int(q.getr()), m);
                     }
                 }
-                g = std::gcd(g.getr(), m);
+                if(g == m) {
+                    do {
+                        ys = f(ys);
+                        g = gcd(_Int((x - ys).getr()), m);
+                    } while(g == 1);
+                }
+                // g = m if the cycle closed on the full value, retry with another t
+                if(g != m) {
+                    return g;
+                }
             }
-            return g.getr();
         });
     }
+    // Prime factors of m with multiplicity, in ascending order
+    // Primes below 64 are divided out first, then the rest goes to Pollard's rho
     template<typename Int>
-    std::generator<Int> factorize(Int m) {
-        if(is_prime(m)) {
-            co_yield m;
-        } else if(m > 1) {
-            auto g = proper_divisor(m);
-            co_yield std::ranges::elements_of(factorize(g));
-            co_yield std::ranges::elements_of(factorize(m / g));
+    std::vector<Int> factorize(Int m) {
+        std::vector<Int> res;
+        if(m == 0) {
+            return res;
         }
+        auto strip = [&](int p) {
+            while(m % p == 0) {
+                res.push_back(p);
+                m /= p;
+            }
+        };
+        strip(2);
+        for(int p: impl::trial_primes) {
+            strip(p);
+        }
+        auto rec = [&](auto &&self, Int m) -> void {
+            if(m < Int(impl::trial_limit) || is_prime(m)) {
+                res.push_back(m);
+            } else {
+                auto g = proper_divisor(m);
+                self(self, g);
+                self(self, m / g);
+            }
+        };
+        if(m > 1) {
+            rec(rec, m);
+        }
+        std::ranges::sort(res);
+        return res;
+    }
+
+    // Keeps factorizations of the last `capacity` distinct numbers
+    template<typename Int>
+    struct factorize_cache {
+        using entry = std::pair<Int, std::vector<Int>>;
+        size_t capacity;
+        std::list<entry> items;
+        std::map<Int, typename std::list<entry>::iterator> pos;
+
+        factorize_cache(size_t capacity = 256): capacity(capacity) {}
+
+        // The reference is valid until `capacity` more numbers are added
+        std::vector<Int> const& operator()(Int m) {
+            if(auto it = pos.find(m); it != end(pos)) {
+                items.splice(begin(items), items, it->second);
+                return it->second->second;
+            }
+            items.emplace_front(m, factorize(m));
+            pos[m] = begin(items);
+            if(size(items) > capacity) {
+                pos.erase(items.back().first);
+                items.pop_back();
+            }
+            return items.front().second;
+        }
+    };
+    // Factorization from a thread-local cache, for numbers
+    // like group orders that get factorized over and over
+    template<typename Int>
+    std::vector<Int> const& factorize_cached(Int m) {
+        thread_local factorize_cache<Int> cache;
+        return cache(m);
+    }
+
+    namespace impl {
+        // Cofactors below bulk_trial_bound^2 left by trial division are primes
+        constexpr uint64_t bulk_trial_bound = 1 << 14;
+        // Odd primes below bulk_trial_bound as {p, p^{-1} mod 2^64, (2^64 - 1) / p}
+        inline auto const& bulk_trial_primes() {
+            static const auto res = []() {
+                std::vector<std::array<uint64_t, 3>> res;
+                for(uint64_t p: base_primes(bulk_trial_bound - 1)) {
+                    if(p > 2) {
+                        res.push_back({p, inv2(p), uint64_t(-1) / p});
+                    }
+                }
+                return res;
+            }();
+            return res;
+        }
+    }
+    // res[i] = factorize(a[i]) for many numbers at once
+    // Primes below 2^14 are divided out of 4 numbers at a time in u64x4 lanes,
+    // cofactors that may be composite go through is_prime_batch together,
+    // and only the composite ones are left to Pollard's rho
+    [[gnu::target("avx2")]] inline std::vector<std::vector<uint64_t>> factorize_many(std::span<uint64_t const> a, size_t threads = num_threads()) {
+        const size_t n = size(a);
+        std::vector<std::vector<uint64_t>> res(n);
+        std::vector<uint64_t> rest(n);
+        auto const& primes = impl::bulk_trial_primes();
+        parallel_for((n + 3) / 4, [&](size_t, size_t l, size_t r) {
+            for(size_t i = 4 * l; i < std::min(4 * r, n); i += 4) {
+                u64x4 x = u64x4() + 1;
+                for(size_t k = 0; k < 4 && i + k < n; k++) {
+                    if(a[i + k]) {
+                        int z = std::countr_zero(a[i + k]);
+                        res[i + k].assign(z, 2);
+                        x[k] = a[i + k] >> z;
+                    }
+                }
+                auto mx = std::ranges::max(std::array{x[0], x[1], x[2], x[3]});
+                for(auto [p, inv, lim]: primes) {
+                    if(p * p > mx) {
+                        break;
+                    }
+                    auto divisible = x * inv <= lim;
+                    if(!_mm256_testz_si256(__m256i(divisible), __m256i(divisible))) [[unlikely]] {
+                        for(size_t k = 0; k < 4; k++) {
+                            // x * p^{-1} is exact while p | x
+                            while(x[k] * inv <= lim) {
+                                x[k] *= inv;
+                                res[i + k].push_back(p);
+                            }
+                        }
+                        mx = std::ranges::max(std::array{x[0], x[1], x[2], x[3]});
+                    }
+                }
+                for(size_t k = 0; k < 4 && i + k < n; k++) {
+                    rest[i + k] = x[k];
+                }
+            }
+        }, threads);
+        std::vector<uint64_t> cand;
+        std::vector<size_t> cand_idx;
+        for(size_t i = 0; i < n; i++) {
+            if(rest[i] >= impl::bulk_trial_bound * impl::bulk_trial_bound) {
+                cand.push_back(rest[i]);
+                cand_idx.push_back(i);
+            } else if(rest[i] > 1) {
+                res[i].push_back(rest[i]);
+            }
+        }
+        auto is_p = std::make_unique<bool[]>(size(cand));
+        is_prime_batch(cand, std::span(is_p.get(), size(cand)));
+        std::vector<size_t> composite;
+        for(size_t j = 0; j < size(cand); j++) {
+            if(is_p[j]) {
+                res[cand_idx[j]].push_back(cand[j]);
+            } else {
+                composite.push_back(cand_idx[j]);
+            }
+        }
+        parallel_for(size(composite), [&](size_t, size_t l, size_t r) {
+            for(size_t j = l; j < r; j++) {
+                auto &fs = res[composite[j]];
+                auto m = rest[composite[j]];
+                // dynamic_modint<int64_t> needs m < 2^62
+                if(m >> 62) {
+                    for(auto p: factorize(uint_n<2>(m))) {
+                        fs.push_back(uint64_t(p));
+                    }
+                } else {
+                    auto more = factorize(m);
+                    fs.insert(end(fs), begin(more), end(more));
+                }
+                std::ranges::sort(fs);
+            }
+        }, threads);
+        return res;
     }
 }
 #endif // CP_ALGO_MATH_FACTORIZE_HPP
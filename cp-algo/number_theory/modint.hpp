@@ -4,14 +4,23 @@
 #include <iostream>
 #include <cassert>
 namespace cp_algo::math {
+    // Unsigned and double-width counterparts of Int,
+    // specialized for multi-limb integers in wide_modint.hpp
+    template<typename Int>
+    struct modint_ints {
+        using UInt = std::make_unsigned_t<Int>;
+        static constexpr size_t bits = sizeof(Int) * 8;
+        using Int2 = std::conditional_t<bits <= 32, int64_t, __int128_t>;
+        using UInt2 = std::conditional_t<bits <= 32, uint64_t, __uint128_t>;
+    };
 
     template<typename modint, typename _Int>
     struct modint_base {
         using Int = _Int;
-        using UInt = std::make_unsigned_t<Int>;
+        using UInt = modint_ints<Int>::UInt;
         static constexpr size_t bits = sizeof(Int) * 8;
-        using Int2 = std::conditional_t<bits <= 32, int64_t, __int128_t>;
-        using UInt2 = std::conditional_t<bits <= 32, uint64_t, __uint128_t>;
+        using Int2 = modint_ints<Int>::Int2;
+        using UInt2 = modint_ints<Int>::UInt2;
         constexpr static Int mod() {
             return modint::mod();
         }
@@ -117,8 +126,11 @@ namespace cp_algo::math {
         using Base::Base;
 
         static Base::UInt m_reduce(Base::UInt2 ab) {
-            if(mod() % 2 == 0) [[unlikely]] {
-                return typename Base::UInt(ab % mod());
+            if(mod() % 2 == 0) {
+                // Barrett reduction, q is at most one less than ab / mod,
+                // so the result is lazily in [0, 2 mod) like in Montgomery
+                typename Base::UInt2 q = mul_high(ab, bm);
+                return typename Base::UInt(ab - q * mod());
             } else {
                 typename Base::UInt2 m = typename Base::UInt(ab) * imod();
                 return typename Base::UInt((ab + m * mod()) >> Base::bits);
@@ -150,6 +162,7 @@ namespace cp_algo::math {
             m = nm;
             im = m % 2 ? inv2(-m) : 0;
             r2 = static_cast<Base::UInt>(static_cast<Base::UInt2>(-1) % m + 1);
+            bm = m % 2 ? 0 : static_cast<Base::UInt2>(-1) / m;
         }
 
         // Wrapper for temp switching
@@ -162,8 +175,21 @@ namespace cp_algo::math {
             return callback();
         }
     private:
+        // floor(a * b / 2^{2 bits})
+        static Base::UInt2 mul_high(Base::UInt2 a, Base::UInt2 b) {
+            if constexpr (Base::bits <= 32) {
+                return uint64_t((__uint128_t(a) * b) >> 64);
+            } else {
+                uint64_t a1 = uint64_t(a >> 64), a0 = uint64_t(a);
+                uint64_t b1 = uint64_t(b >> 64), b0 = uint64_t(b);
+                __uint128_t mid1 = __uint128_t(a1) * b0, mid2 = __uint128_t(a0) * b1;
+                __uint128_t carry = ((__uint128_t(a0) * b0) >> 64) + uint64_t(mid1) + uint64_t(mid2);
+                return __uint128_t(a1) * b1 + (mid1 >> 64) + (mid2 >> 64) + (carry >> 64);
+            }
+        }
         static thread_local Int m;
         static thread_local Base::UInt im, r2;
+        static thread_local Base::UInt2 bm;
     };
     template<typename Int>
     Int thread_local dynamic_modint<Int>::m = 1;
@@ -171,5 +197,73 @@ namespace cp_algo::math {
     dynamic_modint<Int>::Base::UInt thread_local dynamic_modint<Int>::im = -1;
     template<typename Int>
     dynamic_modint<Int>::Base::UInt thread_local dynamic_modint<Int>::r2 = 0;
+    template<typename Int>
+    dynamic_modint<Int>::Base::UInt2 thread_local dynamic_modint<Int>::bm = 0;
+
+    // Modint type with a runtime modulus of type Int
+    template<typename Int>
+    struct modint_for {
+        using type = dynamic_modint<std::make_signed_t<Int>>;
+    };
+    template<typename Int>
+    using modint_for_t = modint_for<Int>::type;
+
+    // Static modulus kept in Montgomery form, so that products
+    // need no division. Values are lazily kept in [0, 2m),
+    // which requires m to be odd and below 2^{bits-2}.
+    template<auto m>
+    struct mont_modint: modint_base<mont_modint<m>, decltype(m)> {
+        using Base = modint_base<mont_modint<m>, decltype(m)>;
+        using Base::Base;
+        using UInt = Base::UInt;
+        using UInt2 = Base::UInt2;
+        static_assert(m % 2 && UInt(m) < (UInt(1) << (Base::bits - 2)), "m must be odd and below 2^{bits-2}");
+
+        static constexpr UInt m_reduce(UInt2 ab) {
+            UInt2 t = UInt(ab) * imod();
+            return UInt((ab + t * mod()) >> Base::bits);
+        }
+        static constexpr UInt m_transform(UInt a) {
+            return m_reduce(a * pw128());
+        }
+        constexpr mont_modint& operator *= (const mont_modint &t) {
+            Base::r = m_reduce(UInt2(Base::r) * t.r);
+            return *this;
+        }
+        constexpr void setr(UInt rr) {
+            Base::r = m_transform(rr);
+        }
+        constexpr UInt getr() const {
+            UInt res = m_reduce(Base::r);
+            return std::min(res, res - mod());
+        }
+        static constexpr Base::Int mod() {return m;}
+        static constexpr UInt remod() {return 2 * UInt(m);}
+        static constexpr UInt imod() {return im;}
+        static constexpr UInt2 pw128() {return r2;}
+    private:
+        static constexpr UInt im = inv2(-UInt(m));
+        static constexpr UInt r2 = UInt(UInt2(-1) % UInt(m) + 1);
+    };
+
+    // Sets the modulus of base in the current thread, no-op for static
+    // modints. Carries dynamic_modint state over to worker threads.
+    template<modint_type base>
+    void set_mod(typename base::Int m) {
+        if constexpr (requires {base::switch_mod(m);}) {
+            base::switch_mod(m);
+        }
+    }
+    namespace impl {
+        // Restores the modulus of T in worker threads, no-op for non-modints
+        template<typename T>
+        auto mod_setter() {
+            if constexpr (modint_type<T>) {
+                return [m = T::mod()]() {set_mod<T>(m);};
+            } else {
+                return []() {};
+            }
+        }
+    }
 }
 #endif // CP_ALGO_MATH_MODINT_HPP
@@ -0,0 +1,222 @@
+#ifndef CP_ALGO_NUMBER_THEORY_MODINT_OPS_HPP
+#define CP_ALGO_NUMBER_THEORY_MODINT_OPS_HPP
+#include "modint.hpp"
+#include "../util/simd.hpp"
+#include <type_traits>
+#include <cstring>
+#include <span>
+#include <bit>
+namespace cp_algo::math {
+    // Element-wise kernels over spans of modints. Types stored as 32-bit
+    // Montgomery forms (mont_modint, dynamic_modint with odd modulus)
+    // are processed in u32x8 lanes, anything else falls back to scalar loops.
+    template<typename T>
+    concept mont_type = modint_type<T> && T::bits <= 32 && requires {T::imod();};
+
+    namespace impl {
+        template<mont_type T>
+        bool use_mont_simd() {
+            return T::mod() % 2 && T::mod() < (1 << 30);
+        }
+        [[gnu::target("avx2")]] inline u32x8 load(auto const* p) {
+            u32x8 res;
+            std::memcpy(&res, p, sizeof(res));
+            return res;
+        }
+        [[gnu::target("avx2")]] inline void store(auto *p, u32x8 x) {
+            std::memcpy(static_cast<void*>(p), &x, sizeof(x));
+        }
+        [[gnu::target("avx2")]] inline u32x8 add(u32x8 a, u32x8 b, uint32_t mod2) {
+            a += b;
+            return a >= mod2 ? a - mod2 : a;
+        }
+        [[gnu::target("avx2")]] inline u32x8 sub(u32x8 a, u32x8 b, uint32_t mod2) {
+            a -= b;
+            return a >= mod2 ? a + mod2 : a;
+        }
+        // Montgomery form of x, broadcast to all lanes
+        template<typename T>
+        [[gnu::target("avx2")]] inline u32x8 bcast(T const& x) {
+            return u32x8() + uint32_t(x.getr_direct());
+        }
+    }
+
+    // a[i] *= b[i]
+    template<typename T>
+    [[gnu::target("avx2")]] void mul_inplace(std::span<T> a, std::type_identity_t<std::span<T const>> b) {
+        size_t i = 0;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                const uint32_t mod = uint32_t(T::mod()), imod = uint32_t(T::imod());
+                for(; i + 8 <= size(a); i += 8) {
+                    impl::store(&a[i], montgomery_mul(impl::load(&a[i]), impl::load(&b[i]), mod, imod));
+                }
+            }
+        }
+        for(; i < size(a); i++) {
+            a[i] *= b[i];
+        }
+    }
+    // a[i] *= x
+    template<typename T>
+    [[gnu::target("avx2")]] void mul_inplace(std::span<T> a, std::type_identity_t<T> x) {
+        size_t i = 0;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                const uint32_t mod = uint32_t(T::mod()), imod = uint32_t(T::imod());
+                auto xv = impl::bcast(x);
+                for(; i + 8 <= size(a); i += 8) {
+                    impl::store(&a[i], montgomery_mul(impl::load(&a[i]), xv, mod, imod));
+                }
+            }
+        }
+        for(; i < size(a); i++) {
+            a[i] *= x;
+        }
+    }
+    // a[i] += b[i]
+    template<typename T>
+    [[gnu::target("avx2")]] void add_inplace(std::span<T> a, std::type_identity_t<std::span<T const>> b) {
+        size_t i = 0;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                const uint32_t mod2 = 2 * uint32_t(T::mod());
+                for(; i + 8 <= size(a); i += 8) {
+                    impl::store(&a[i], impl::add(impl::load(&a[i]), impl::load(&b[i]), mod2));
+                }
+            }
+        }
+        for(; i < size(a); i++) {
+            a[i] += b[i];
+        }
+    }
+    // a[i] -= b[i]
+    template<typename T>
+    [[gnu::target("avx2")]] void sub_inplace(std::span<T> a, std::type_identity_t<std::span<T const>> b) {
+        size_t i = 0;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                const uint32_t mod2 = 2 * uint32_t(T::mod());
+                for(; i + 8 <= size(a); i += 8) {
+                    impl::store(&a[i], impl::sub(impl::load(&a[i]), impl::load(&b[i]), mod2));
+                }
+            }
+        }
+        for(; i < size(a); i++) {
+            a[i] -= b[i];
+        }
+    }
+    // a[i] += b[i] * x
+    template<typename T>
+    [[gnu::target("avx2")]] void fma_inplace(std::span<T> a, std::type_identity_t<std::span<T const>> b, std::type_identity_t<T> x) {
+        size_t i = 0;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                const uint32_t mod = uint32_t(T::mod()), imod = uint32_t(T::imod());
+                auto xv = impl::bcast(x);
+                for(; i + 8 <= size(a); i += 8) {
+                    auto bx = montgomery_mul(impl::load(&b[i]), xv, mod, imod);
+                    impl::store(&a[i], impl::add(impl::load(&a[i]), bx, 2 * mod));
+                }
+            }
+        }
+        for(; i < size(a); i++) {
+            a[i] += b[i] * x;
+        }
+    }
+    // a[i] *= x^i
+    template<typename T>
+    [[gnu::target("avx2")]] void mul_pows_inplace(std::span<T> a, std::type_identity_t<T> x) {
+        size_t i = 0;
+        T cur = 1;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                const uint32_t mod = uint32_t(T::mod()), imod = uint32_t(T::imod());
+                u32x8 pw;
+                for(size_t j = 0; j < 8; j++) {
+                    pw[j] = uint32_t(cur.getr_direct());
+                    cur *= x;
+                }
+                auto step = impl::bcast(cur);
+                for(; i + 8 <= size(a); i += 8) {
+                    impl::store(&a[i], montgomery_mul(impl::load(&a[i]), pw, mod, imod));
+                    pw = montgomery_mul(pw, step, mod, imod);
+                }
+                cur.setr_direct(typename T::UInt(pw[0]));
+            }
+        }
+        for(; i < size(a); i++) {
+            a[i] *= cur;
+            cur *= x;
+        }
+    }
+    // a[i] = a[i]^n, square-and-multiply on 4 vectors at once so that
+    // their multiplications overlap in the pipeline
+    template<typename T>
+    [[gnu::target("avx2")]] void pow_inplace(std::span<T> a, uint64_t n) {
+        size_t i = 0;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                constexpr size_t accum = 4;
+                const uint32_t mod = uint32_t(T::mod()), imod = uint32_t(T::imod());
+                const auto one = impl::bcast(T(1));
+                for(; i + 8 * accum <= size(a); i += 8 * accum) {
+                    u32x8 x[accum], r[accum];
+                    for(size_t z = 0; z < accum; z++) {
+                        x[z] = impl::load(&a[i + 8 * z]);
+                        r[z] = one;
+                    }
+                    for(int b = int(std::bit_width(n)); b-- > 0;) {
+                        for(size_t z = 0; z < accum; z++) {
+                            r[z] = montgomery_mul(r[z], r[z], mod, imod);
+                            if(n >> b & 1) {
+                                r[z] = montgomery_mul(r[z], x[z], mod, imod);
+                            }
+                        }
+                    }
+                    for(size_t z = 0; z < accum; z++) {
+                        impl::store(&a[i + 8 * z], r[z]);
+                    }
+                }
+            }
+        }
+        for(; i < size(a); i++) {
+            a[i] = bpow(a[i], n);
+        }
+    }
+    // sum a[i] * x^i, Horner's scheme in x^8 over 8 lanes
+    template<typename T>
+    [[gnu::target("avx2")]] T eval(std::span<T const> a, std::type_identity_t<T> x) {
+        size_t n = size(a), blocks = 0;
+        if constexpr (mont_type<T>) {
+            if(impl::use_mont_simd<T>()) {
+                blocks = n / 8;
+            }
+        }
+        T res(0);
+        for(size_t i = n; i > 8 * blocks; i--) {
+            res *= x;
+            res += a[i - 1];
+        }
+        if constexpr (mont_type<T>) {
+            if(blocks) {
+                const uint32_t mod = uint32_t(T::mod()), imod = uint32_t(T::imod());
+                auto x8v = impl::bcast(bpow(x, 8));
+                u32x8 acc = {uint32_t(res.getr_direct())};
+                for(size_t b = blocks; b-- > 0;) {
+                    acc = montgomery_mul(acc, x8v, mod, imod);
+                    acc = impl::add(acc, impl::load(&a[8 * b]), 2 * mod);
+                }
+                res = T(0);
+                for(size_t j = 8; j-- > 0;) {
+                    T lane;
+                    lane.setr_direct(typename T::UInt(acc[j]));
+                    res *= x;
+                    res += lane;
+                }
+            }
+        }
+        return res;
+    }
+}
+#endif // CP_ALGO_NUMBER_THEORY_MODINT_OPS_HPP
@@ -1,24 +1,31 @@
 #ifndef CP_ALGO_NUMBER_THEORY_PRIMALITY_HPP
 #define CP_ALGO_NUMBER_THEORY_PRIMALITY_HPP
 #include "modint.hpp"
+#include "../random/rng.hpp"
+#include "../util/simd.hpp"
 #include <algorithm>
+#include <ranges>
+#include <vector>
+#include <array>
+#include <span>
 #include <bit>
 namespace cp_algo::math {
     // https://en.wikipedia.org/wiki/Miller–Rabin_primality_test
     template<typename _Int>
     bool is_prime(_Int m) {
-        using Int = std::make_signed_t<_Int>;
-        using UInt = std::make_unsigned_t<Int>;
+        using base = modint_for_t<_Int>;
+        using UInt = base::UInt;
         if(m == 1 || m % 2 == 0) {
             return m == 2;
         }
         // m - 1 = 2^s * d
-        int s = std::countr_zero(UInt(m - 1));
+        using std::countr_zero;
+        int s = int(countr_zero(UInt(m - 1)));
         auto d = (m - 1) >> s;
-        using base = dynamic_modint<Int>;
         auto test = [&](base x) {
             x = bpow(x, d);
-            if(std::abs(x.rem()) <= 1) {
+            // x = 0 when the base is a multiple of m
+            if(x == 0 || x == 1 || x == -1) {
                 return true;
             }
             for(int i = 1; i < s && x != -1; i++) {
@@ -27,11 +34,175 @@ namespace cp_algo::math {
             return x == -1;
         };
         return base::with_mod(m, [&](){
-            // Works for all m < 2^64: https://miller-rabin.appspot.com
-            return std::ranges::all_of(std::array{
-                2, 325, 9375, 28178, 450775, 9780504, 1795265022
-            }, test);
+            if constexpr (base::bits <= 64) {
+                // Works for all m < 2^64: https://miller-rabin.appspot.com
+                return std::ranges::all_of(std::array{
+                    2, 325, 9375, 28178, 450775, 9780504, 1795265022
+                }, test);
+            } else {
+                // Deterministic below 3.3 * 10^24, then random bases
+                // with error probability below 4^{-32}
+                return std::ranges::all_of(std::array{
+                    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41
+                }, test) && std::ranges::all_of(std::views::iota(0, 32), [&](int) {
+                    return test(base(random::rng()));
+                });
+            }
         });
     }
+
+    namespace impl {
+        // Odd primes for trial division with their inverses mod 2^64:
+        // p | n iff n * p^{-1} <= (2^64 - 1) / p
+        constexpr std::array trial_primes = {
+            3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61
+        };
+        // Numbers below it without small factors are primes
+        constexpr uint64_t trial_limit = 67 * 67;
+        constexpr auto trial_invs = []() {
+            std::array<std::array<uint64_t, 2>, size(trial_primes)> res;
+            for(size_t i = 0; i < size(trial_primes); i++) {
+                uint64_t p = trial_primes[i];
+                res[i] = {inv2(p), uint64_t(-1) / p};
+            }
+            return res;
+        }();
+        // 0 for composite, 1 for prime, 2 if it needs Miller-Rabin
+        inline int trial_division(uint64_t n) {
+            if(n < 2 || n % 2 == 0) {
+                return n == 2;
+            }
+            for(size_t i = 0; i < size(trial_primes); i++) {
+                auto [inv, lim] = trial_invs[i];
+                if(n * inv <= lim) {
+                    return n == uint64_t(trial_primes[i]);
+                }
+            }
+            return n < trial_limit ? 1 : 2;
+        }
+
+        // x * y / 2^32 mod n in each lane, n odd and below 2^32, ninv = n^{-1} mod 2^32
+        // Exact: x * y - q * n is divisible by 2^32 and lies in (-n 2^32, n 2^32)
+        [[gnu::target("avx2")]] inline u64x4 mont_mul32(u64x4 x, u64x4 y, u64x4 n, u64x4 ninv) {
+            auto xy = u64x4(_mm256_mul_epu32(__m256i(x), __m256i(y)));
+            auto q = u64x4(_mm256_mul_epu32(__m256i(xy), __m256i(ninv)));
+            auto qn = u64x4(_mm256_mul_epu32(__m256i(q), __m256i(n)));
+            auto hi = xy >> 32, lo = qn >> 32;
+            return hi < lo ? hi - lo + n : hi - lo;
+        }
+        // Miller-Rabin with bases 2, 7, 61, each lane with its own odd n < 2^32
+        // Deterministic for n < 4759123141
+        [[gnu::target("avx2")]] inline u64x4 is_prime32x4(u64x4 n) {
+            u64x4 ninv, r2, one, d, s;
+            for(int k = 0; k < 4; k++) {
+                ninv[k] = inv2(uint32_t(n[k]));
+                r2[k] = uint64_t(-n[k]) % n[k];
+                one[k] = (uint64_t(1) << 32) % n[k];
+                s[k] = std::countr_zero(n[k] - 1);
+                d[k] = (n[k] - 1) >> s[k];
+            }
+            auto mone = n - one;
+            int max_s = int(std::ranges::max(std::array{s[0], s[1], s[2], s[3]}));
+            u64x4 res = u64x4() + 1;
+            for(uint64_t b: {2, 7, 61}) {
+                auto bm = mont_mul32(u64x4() + b, r2, n, ninv);
+                auto x = one;
+                for(int i = 31; i >= 0; i--) {
+                    x = mont_mul32(x, x, n, ninv);
+                    auto y = mont_mul32(x, bm, n, ninv);
+                    x = (d >> i & 1) ? y : x;
+                }
+                // lanes are 0 or -1
+                auto ok = u64x4((x == one) | (x == mone));
+                for(int i = 1; i < max_s; i++) {
+                    x = mont_mul32(x, x, n, ninv);
+                    ok |= u64x4((x == mone) & (u64x4() + i < s));
+                }
+                res &= ok;
+            }
+            return res;
+        }
+
+        // Miller-Rabin for 4 odd n < 2^64 at once, the chains are
+        // independent, so the multiplications overlap in the pipeline
+        inline std::array<bool, 4> is_prime64x4(std::array<uint64_t, 4> n) {
+            std::array<uint64_t, 4> ninv, r2, one, d;
+            std::array<int, 4> s;
+            for(int k = 0; k < 4; k++) {
+                ninv[k] = inv2(n[k]);
+                one[k] = uint64_t(-n[k]) % n[k];
+                r2[k] = uint64_t(__uint128_t(one[k]) * one[k] % n[k]);
+                s[k] = std::countr_zero(n[k] - 1);
+                d[k] = (n[k] - 1) >> s[k];
+            }
+            auto mul = [&](uint64_t x, uint64_t y, int k) {
+                auto xy = __uint128_t(x) * y;
+                auto q = uint64_t(xy) * ninv[k];
+                auto hi = uint64_t(xy >> 64), lo = uint64_t(__uint128_t(q) * n[k] >> 64);
+                return hi < lo ? hi - lo + n[k] : hi - lo;
+            };
+            int bits = int(std::bit_width(std::ranges::max(d)));
+            std::array<bool, 4> res = {true, true, true, true};
+            // Bases are below 2^32 <= n
+            for(uint64_t b: {2, 325, 9375, 28178, 450775, 9780504, 1795265022}) {
+                std::array<uint64_t, 4> x, bm;
+                for(int k = 0; k < 4; k++) {
+                    x[k] = one[k];
+                    bm[k] = mul(b, r2[k], k);
+                }
+                for(int i = bits - 1; i >= 0; i--) {
+                    for(int k = 0; k < 4; k++) {
+                        x[k] = mul(x[k], x[k], k);
+                        auto y = mul(x[k], bm[k], k);
+                        x[k] = (d[k] >> i & 1) ? y : x[k];
+                    }
+                }
+                for(int k = 0; k < 4; k++) {
+                    bool ok = x[k] == one[k] || x[k] == n[k] - one[k];
+                    for(int i = 1; i < s[k] && !ok; i++) {
+                        x[k] = mul(x[k], x[k], k);
+                        ok = x[k] == n[k] - one[k];
+                    }
+                    res[k] = res[k] && ok;
+                }
+            }
+            return res;
+        }
+    }
+
+    // res[i] = is_prime(a[i]) for a batch of numbers
+    // Trial division by primes below 64 first, then Miller-Rabin in groups
+    // of 4: in u64x4 lanes for n < 2^32, in interleaved chains otherwise
+    [[gnu::target("avx2")]] inline void is_prime_batch(std::span<uint64_t const> a, std::span<bool> res) {
+        assert(size(a) == size(res));
+        std::vector<size_t> small, large;
+        for(size_t i = 0; i < size(a); i++) {
+            int t = impl::trial_division(a[i]);
+            res[i] = t;
+            if(t == 2) {
+                (a[i] >> 32 ? large : small).push_back(i);
+            }
+        }
+        for(size_t i = 0; i < size(small); i += 4) {
+            u64x4 n;
+            for(size_t k = 0; k < 4; k++) {
+                n[k] = a[small[std::min(i + k, size(small) - 1)]];
+            }
+            auto ok = impl::is_prime32x4(n);
+            for(size_t k = 0; k < 4 && i + k < size(small); k++) {
+                res[small[i + k]] = ok[k];
+            }
+        }
+        for(size_t i = 0; i < size(large); i += 4) {
+            std::array<uint64_t, 4> n;
+            for(size_t k = 0; k < 4; k++) {
+                n[k] = a[large[std::min(i + k, size(large) - 1)]];
+            }
+            auto ok = impl::is_prime64x4(n);
+            for(size_t k = 0; k < 4 && i + k < size(large); k++) {
+                res[large[i + k]] = ok[k];
+            }
+        }
+    }
 }
 #endif // CP_ALGO_NUMBER_THEORY_PRIMALITY_HPP
@@ -0,0 +1,190 @@
+#ifndef CP_ALGO_NUMBER_THEORY_PRIME_SUMS_HPP
+#define CP_ALGO_NUMBER_THEORY_PRIME_SUMS_HPP
+#include "sieve.hpp"
+#include "../util/big_alloc.hpp"
+#include "../util/parallel.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+namespace cp_algo::math {
+    // G(v) = sum_{p <= v} f(p) over primes for all distinct v = n / i,
+    // lo[v] for v <= sq = isqrt(n) and hi[i] = G(n / i) for i <= sq
+    template<typename T>
+    struct prime_sums {
+        uint64_t n, sq;
+        std::vector<T, big_alloc<T>> lo, hi;
+
+        T operator()(uint64_t v) const {
+            return v <= sq ? lo[v] : hi[n / v];
+        }
+        prime_sums& operator += (prime_sums const& t) {
+            for(size_t i = 0; i <= sq; i++) {
+                lo[i] += t.lo[i];
+                hi[i] += t.hi[i];
+            }
+            return *this;
+        }
+        prime_sums& operator -= (prime_sums const& t) {
+            for(size_t i = 0; i <= sq; i++) {
+                lo[i] -= t.lo[i];
+                hi[i] -= t.hi[i];
+            }
+            return *this;
+        }
+        prime_sums& operator *= (T const& x) {
+            for(size_t i = 0; i <= sq; i++) {
+                lo[i] *= x;
+                hi[i] *= x;
+            }
+            return *this;
+        }
+        prime_sums operator + (prime_sums const& t) const {return prime_sums(*this) += t;}
+        prime_sums operator - (prime_sums const& t) const {return prime_sums(*this) -= t;}
+        prime_sums operator * (T const& x) const {return prime_sums(*this) *= x;}
+    };
+
+    // Lucy_Hedgehog's sieve in O(n^{3/4} / log n) for a completely multiplicative f
+    // with known F(v) = sum_{2 <= i <= v} f(i). Starting with S = F, for each prime p
+    // S(v) -= f(p) (S(v / p) - S(p - 1)) removes the numbers with least prime factor p.
+    // Each round splits its updates into a part that reads values from the same round
+    // and runs in order, and a part that only reads older values and runs in threads.
+    template<typename T>
+    prime_sums<T> lucy(uint64_t n, auto &&f, auto &&F, size_t threads = num_threads()) {
+        const uint64_t sq = impl::isqrt(n);
+        prime_sums<T> G{n, sq, {}, {}};
+        G.lo.resize(sq + 1);
+        G.hi.resize(sq + 1);
+        auto &lo = G.lo, &hi = G.hi;
+        std::vector<uint64_t, big_alloc<uint64_t>> hv(sq + 1);
+        for(uint64_t v = 1; v <= sq; v++) {
+            lo[v] = F(v);
+            hv[v] = n / v;
+            hi[v] = F(hv[v]);
+        }
+        auto restore_mod = impl::mod_setter<T>();
+        // Spawning threads only pays off on long ranges
+        auto split = [&](uint64_t l, uint64_t r, auto &&upd) {
+            if(l >= r) {
+                return;
+            }
+            parallel_for(r - l, [&](size_t, size_t a, size_t b) {
+                restore_mod();
+                for(uint64_t i = l + a; i < l + b; i++) {
+                    upd(i);
+                }
+            }, r - l >= (1 << 16) ? threads : 1);
+        };
+        for(uint64_t p: impl::base_primes(sq)) {
+            const T fp = f(p), c = lo[p - 1];
+            // v / p through doubles is off by at most one for v < 2^53
+            const double pinv = 1. / double(p);
+            auto div = [&](uint64_t v) {
+                auto q = uint64_t(double(v) * pinv);
+                q -= q * p > v;
+                q += (q + 1) * p <= v;
+                return q;
+            };
+            const uint64_t lim = std::min(sq, n / (p * p)), mid = std::min(lim, sq / p);
+            // hi[i] for i <= mid reads hi[ip] of the same round from above
+            for(uint64_t i = 1; i <= mid; i++) {
+                hi[i] -= fp * (hi[i * p] - c);
+            }
+            split(mid + 1, lim + 1, [&](uint64_t i) {
+                hi[i] -= fp * (lo[div(hv[i])] - c);
+            });
+            // lo[v] for v > sq / p reads lo below sq / p, which is updated after
+            const uint64_t top = std::min(sq, sq / p);
+            split(std::max(p * p, top + 1), sq + 1, [&](uint64_t v) {
+                lo[v] -= fp * (lo[div(v)] - c);
+            });
+            for(uint64_t v = top; v >= p * p; v--) {
+                lo[v] -= fp * (lo[div(v)] - c);
+            }
+        }
+        return G;
+    }
+
+    // sum_{1 <= i <= n} f(i) for a multiplicative f with f(p^k) = fpk(p, k),
+    // given G(v) = sum_{p <= v} f(p) from lucy. Min_25's second phase:
+    // S(v, j) = sum of f(i) for 2 <= i <= v with all prime factors at least p_j
+    template<typename T>
+    T multiplicative_sum(prime_sums<T> const& G, auto &&fpk) {
+        const auto primes = impl::base_primes(G.sq);
+        auto rec = [&](auto &&self, uint64_t v, size_t j) -> T {
+            T res = G(v);
+            if(j) {
+                res -= G.lo[primes[j - 1]];
+            }
+            for(size_t k = j; k < size(primes) && uint64_t(primes[k]) * primes[k] <= v; k++) {
+                uint64_t p = primes[k];
+                for(uint64_t pe = p, e = 1; pe * p <= v; pe *= p, e++) {
+                    res += fpk(p, e) * self(self, v / pe, k + 1) + fpk(p, e + 1);
+                }
+            }
+            return res;
+        };
+        return rec(rec, G.n, 0) + T(1);
+    }
+
+    // Number of primes up to n
+    inline int64_t count_primes(uint64_t n, size_t threads = num_threads()) {
+        return lucy<int64_t>(n, [](uint64_t) {
+            return int64_t(1);
+        }, [](uint64_t v) {
+            return int64_t(v) - 1;
+        }, threads)(n);
+    }
+    // G(v) = number of primes up to v
+    template<typename T>
+    prime_sums<T> prime_counts(uint64_t n, size_t threads = num_threads()) {
+        return lucy<T>(n, [](uint64_t) {
+            return T(1);
+        }, [](uint64_t v) {
+            return T(v) - T(1);
+        }, threads);
+    }
+    // G(v) = sum of primes up to v
+    template<typename T>
+    prime_sums<T> prime_totals(uint64_t n, size_t threads = num_threads()) {
+        return lucy<T>(n, [](uint64_t p) {
+            return T(p);
+        }, [](uint64_t v) {
+            // v (v + 1) / 2 - 1 without dividing T
+            return (v % 2 ? T(v) * T((v + 1) / 2) : T(v / 2) * T(v + 1)) - T(1);
+        }, threads);
+    }
+    // sum_{i <= n} phi(i)
+    template<typename T>
+    T totient_sum(uint64_t n, size_t threads = num_threads()) {
+        if(n == 0) {
+            return T(0);
+        }
+        auto G = prime_totals<T>(n, threads) - prime_counts<T>(n, threads);
+        return multiplicative_sum(G, [](uint64_t p, uint64_t k) {
+            return bpow(T(p), k - 1) * T(p - 1);
+        });
+    }
+    // sum_{i <= n} mu(i)
+    template<typename T>
+    T mertens(uint64_t n, size_t threads = num_threads()) {
+        if(n == 0) {
+            return T(0);
+        }
+        auto G = prime_counts<T>(n, threads) * T(-1);
+        return multiplicative_sum(G, [](uint64_t, uint64_t k) {
+            return k == 1 ? T(-1) : T(0);
+        });
+    }
+    // sum_{i <= n} d(i), the number of divisors
+    template<typename T>
+    T divisor_count_sum(uint64_t n, size_t threads = num_threads()) {
+        if(n == 0) {
+            return T(0);
+        }
+        auto G = prime_counts<T>(n, threads) * T(2);
+        return multiplicative_sum(G, [](uint64_t, uint64_t k) {
+            return T(k + 1);
+        });
+    }
+}
+#endif // CP_ALGO_NUMBER_THEORY_PRIME_SUMS_HPP
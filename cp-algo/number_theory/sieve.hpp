@@ -0,0 +1,260 @@
+#ifndef CP_ALGO_NUMBER_THEORY_SIEVE_HPP
+#define CP_ALGO_NUMBER_THEORY_SIEVE_HPP
+#include "modint.hpp"
+#include "../structures/bit_array.hpp"
+#include "../util/big_alloc.hpp"
+#include "../util/parallel.hpp"
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <array>
+#include <span>
+#include <bit>
+namespace cp_algo::math {
+    namespace impl {
+        // Residues coprime to 30, one bit per residue, so a byte covers 30 numbers
+        constexpr std::array<uint8_t, 8> wheel = {1, 7, 11, 13, 17, 19, 23, 29};
+        constexpr auto wheel_pos = []() {
+            std::array<uint8_t, 30> res = {};
+            for(uint8_t j = 0; j < 8; j++) {
+                res[wheel[j]] = j;
+            }
+            return res;
+        }();
+        // Wheel bytes per segment of prime_blocks, 128 KiB of bits fit in L2
+        constexpr uint64_t wheel_segment = 1 << 17;
+        // Numbers per segment of spf_range and multiplicative_range
+        constexpr uint64_t range_segment = 1 << 15;
+
+        inline uint64_t isqrt(uint64_t n) {
+            auto r = uint64_t(std::sqrt(double(n)));
+            while(r * r > n) {
+                r--;
+            }
+            while((r + 1) * (r + 1) <= n) {
+                r++;
+            }
+            return r;
+        }
+        // Primes up to n, plain sieve over odd numbers
+        inline std::vector<uint32_t> base_primes(uint64_t n) {
+            std::vector<uint32_t> res;
+            if(n < 2) {
+                return res;
+            }
+            res.push_back(2);
+            structures::dynamic_bit_array odd(n / 2 + 1);
+            odd.set_all();
+            for(uint64_t i = 3; i <= n; i += 2) {
+                if(odd[i / 2]) {
+                    res.push_back(uint32_t(i));
+                    for(uint64_t j = i * i; j <= n; j += 2 * i) {
+                        odd.reset(j / 2);
+                    }
+                }
+            }
+            return res;
+        }
+    }
+
+    // Segmented sieve of Eratosthenes over the mod 30 wheel
+    // Calls callback(t, primes) for consecutive blocks of [lo, hi), where
+    // primes is a span of the primes in the block in ascending order.
+    // Blocks are split into contiguous chunks between threads, so calls
+    // may run concurrently, but the ones with the same t come in order
+    void prime_blocks(uint64_t lo, uint64_t hi, auto &&callback, size_t threads = num_threads()) {
+        using impl::wheel, impl::wheel_pos;
+        if(lo >= hi) {
+            return;
+        }
+        const auto sieving = impl::base_primes(impl::isqrt(hi - 1));
+        const uint64_t seg = impl::wheel_segment;
+        const uint64_t k_lo = lo / 30, k_hi = (hi + 29) / 30;
+        parallel_for((k_hi - k_lo + seg - 1) / seg, [&](size_t t, size_t l, size_t r) {
+            structures::dynamic_bit_array bits(8 * seg);
+            std::vector<uint64_t> primes;
+            for(size_t s = l; s < r; s++) {
+                uint64_t k0 = k_lo + s * seg, k1 = std::min(k0 + seg, k_hi);
+                uint64_t len = 8 * (k1 - k0);
+                bits.set_all();
+                primes.clear();
+                if(k0 == 0) {
+                    for(uint64_t p: {2, 3, 5}) {
+                        if(lo <= p && p < hi) {
+                            primes.push_back(p);
+                        }
+                    }
+                    // 1 is not a prime
+                    bits.reset(0);
+                }
+                for(uint64_t p: sieving) {
+                    if(p * p >= 30 * k1) {
+                        break;
+                    } else if(p < 7) {
+                        continue;
+                    }
+                    // p * m for m >= p on each wheel residue,
+                    // they are 30p apart, so p bytes apart in bits
+                    uint64_t m0 = std::max(p, (30 * k0 + p - 1) / p);
+                    for(auto w: wheel) {
+                        uint64_t x = p * (m0 + (w + 30 - m0 % 30) % 30);
+                        for(uint64_t b = 8 * (x / 30 - k0) + wheel_pos[x % 30]; b < len; b += 8 * p) {
+                            bits.reset(b);
+                        }
+                    }
+                }
+                for(size_t i = 0; i < (len + 63) / 64; i++) {
+                    for(uint64_t w = bits.word(i); w; w &= w - 1) {
+                        uint64_t b = 64 * i + std::countr_zero(w);
+                        uint64_t x = 30 * (k0 + b / 8) + wheel[b % 8];
+                        if(lo <= x && x < hi) {
+                            primes.push_back(x);
+                        }
+                    }
+                }
+                callback(t, std::span<uint64_t const>(primes));
+            }
+        }, threads);
+    }
+    // All primes in [lo, hi)
+    auto primes_range(uint64_t lo, uint64_t hi, size_t threads = num_threads()) {
+        std::vector<std::vector<uint64_t, big_alloc<uint64_t>>> parts(threads);
+        prime_blocks(lo, hi, [&](size_t t, auto primes) {
+            parts[t].insert(end(parts[t]), begin(primes), end(primes));
+        }, threads);
+        std::vector<uint64_t, big_alloc<uint64_t>> res;
+        for(auto &part: parts) {
+            res.insert(end(res), begin(part), end(part));
+        }
+        return res;
+    }
+
+    // res[i] = smallest prime factor of lo + i, with spf(1) = 1, lo >= 1
+    template<typename Int = uint64_t>
+    auto spf_range(uint64_t lo, uint64_t hi, size_t threads = num_threads()) {
+        assert(lo >= 1);
+        std::vector<Int, big_alloc<Int>> res(hi > lo ? hi - lo : 0);
+        if(lo >= hi) {
+            return res;
+        }
+        const auto sieving = impl::base_primes(impl::isqrt(hi - 1));
+        const uint64_t seg = impl::range_segment;
+        parallel_for((hi - lo + seg - 1) / seg, [&](size_t, size_t l, size_t r) {
+            for(size_t s = l; s < r; s++) {
+                uint64_t a = lo + s * seg, b = std::min(a + seg, hi);
+                auto out = res.data() + (a - lo);
+                for(uint64_t p: sieving) {
+                    if(p * p >= b) {
+                        break;
+                    }
+                    for(uint64_t n = std::max(p * p, (a + p - 1) / p * p); n < b; n += p) {
+                        if(!out[n - a]) {
+                            out[n - a] = Int(p);
+                        }
+                    }
+                }
+                for(uint64_t n = a; n < b; n++) {
+                    if(!out[n - a]) {
+                        out[n - a] = Int(n);
+                    }
+                }
+            }
+        }, threads);
+        return res;
+    }
+
+    // res[i] = f(lo + i) for a multiplicative f given by f(p, k) = f(p^k), lo >= 1
+    // Each segment divides out the primes up to sqrt(hi), what is left is 1 or a prime
+    template<typename T>
+    auto multiplicative_range(uint64_t lo, uint64_t hi, auto &&f, size_t threads = num_threads()) {
+        assert(lo >= 1);
+        std::vector<T, big_alloc<T>> res(hi > lo ? hi - lo : 0, T(1));
+        if(lo >= hi) {
+            return res;
+        }
+        // {p, p^{-1} mod 2^64, (2^64 - 1) / p}, p | x iff x * p^{-1} <= (2^64 - 1) / p
+        std::vector<std::array<uint64_t, 3>> divs;
+        for(uint64_t p: impl::base_primes(impl::isqrt(hi - 1))) {
+            divs.push_back({p, p % 2 ? inv2(p) : 0, uint64_t(-1) / p});
+        }
+        const uint64_t seg = impl::range_segment;
+        auto restore_mod = impl::mod_setter<T>();
+        parallel_for((hi - lo + seg - 1) / seg, [&](size_t, size_t l, size_t r) {
+            restore_mod();
+            std::vector<uint64_t> rem(seg);
+            for(size_t s = l; s < r; s++) {
+                uint64_t a = lo + s * seg, b = std::min(a + seg, hi);
+                auto out = res.data() + (a - lo);
+                std::iota(begin(rem), begin(rem) + (b - a), a);
+                for(auto [p, inv, lim]: divs) {
+                    if(p * p >= b) {
+                        break;
+                    }
+                    for(uint64_t n = (a + p - 1) / p * p; n < b; n += p) {
+                        auto &x = rem[n - a];
+                        int k = 1;
+                        if(p == 2) {
+                            k = std::countr_zero(x);
+                            x >>= k;
+                        } else {
+                            // x * p^{-1} is exact while p | x
+                            x *= inv;
+                            while(x * inv <= lim) {
+                                x *= inv;
+                                k++;
+                            }
+                        }
+                        out[n - a] *= f(p, k);
+                    }
+                }
+                for(uint64_t n = a; n < b; n++) {
+                    if(rem[n - a] > 1) {
+                        out[n - a] *= f(rem[n - a], 1);
+                    }
+                }
+            }
+        }, threads);
+        return res;
+    }
+    // Euler's totient of lo + i
+    auto phi_range(uint64_t lo, uint64_t hi, size_t threads = num_threads()) {
+        return multiplicative_range<uint64_t>(lo, hi, [](uint64_t p, int k) {
+            return bpow(p, k - 1) * (p - 1);
+        }, threads);
+    }
+    // Möbius function of lo + i
+    auto mobius_range(uint64_t lo, uint64_t hi, size_t threads = num_threads()) {
+        return multiplicative_range<int>(lo, hi, [](uint64_t, int k) {
+            return k == 1 ? -1 : 0;
+        }, threads);
+    }
+    // res[i] = i^d for i < n, n <= 2^32
+    // Only primes take a bpow, others are res[p] * res[i / p] for p = spf(i),
+    // filled in by ranges [m, 2m) that only depend on the previous ones
+    template<typename T>
+    auto pow_range(uint64_t n, uint64_t d, size_t threads = num_threads()) {
+        assert(n <= (1ULL << 32));
+        std::vector<T, big_alloc<T>> res(n);
+        if(n == 0) {
+            return res;
+        }
+        res[0] = bpow(T(0), d);
+        auto spf = spf_range<uint32_t>(1, n, threads);
+        auto restore_mod = impl::mod_setter<T>();
+        for(uint64_t m = 1; m < n; m *= 2) {
+            uint64_t e = std::min(2 * m, n);
+            parallel_for(e - m, [&](size_t, size_t l, size_t r) {
+                restore_mod();
+                for(uint64_t i = m + l; i < m + r; i++) {
+                    uint64_t p = spf[i - 1];
+                    res[i] = p == i ? bpow(T(i), d) : res[p] * res[i / p];
+                }
+            }, std::min(threads, size_t((e - m) >> 12) + 1));
+        }
+        return res;
+    }
+}
+#endif // CP_ALGO_NUMBER_THEORY_SIEVE_HPP
@@ -5,7 +5,6 @@
 #include <cassert>
 #include <utility>
 #include <vector>
-#include <map>
 namespace cp_algo::math {
     template<typename T>
     using gaussint = complex<T>;
@@ -18,8 +17,13 @@ namespace cp_algo::math {
         using Int = std::make_signed_t<_Int>;
         using base = dynamic_modint<Int>;
         return base::with_mod(p, [&](){
-            base g = primitive_root(p);
-            int64_t i = bpow(g, (p - 1) / 4).getr();
+            // z^{(p-1)/4} for a non-residue z is a square root of -1,
+            // so there is no need to factorize p - 1 for a primitive root
+            base z = 2;
+            while(bpow(z, (p - 1) / 2) == base(1)) {
+                z += base(1);
+            }
+            int64_t i = bpow(z, (p - 1) / 4).getr();
             int64_t q0 = 1, q1 = 0;
             int64_t r = i, m = p;
             // TODO: Use library contfrac?
@@ -32,53 +36,101 @@ namespace cp_algo::math {
         });
     }
 
+    namespace impl {
+        // cb(p, c) for each prime p that divides n exactly c times, in ascending order
+        template<typename Int>
+        void visit_prime_powers(Int n, auto &&cb) {
+            auto primes = factorize(n);
+            for(size_t i = 0, j = 0; i < size(primes); i = j) {
+                while(j < size(primes) && primes[j] == primes[i]) {
+                    j++;
+                }
+                cb(primes[i], int(j - i));
+            }
+        }
+    }
+
+    // Calls cb(z) for all z = x + iy with x, y >= 0 and x^2 + y^2 = n
+    // For primes p = 1 mod 4 with p^c || n and p = pi conj(pi), z takes pi^d conj(pi)^{c-d},
+    // so representations are the numbers with digits d in mixed radix c + 1,
+    // visited depth-first with one product per digit kept on the recursion stack
     template<typename Int>
-    std::vector<gaussint<Int>> two_squares_all(Int n) {
+    void two_squares_visit(Int n, auto &&cb) {
         if(n == 0) {
-            return {0};
+            cb(gaussint<Int>(0));
+            return;
         }
-        auto primes = factorize(n);
-        std::map<Int, int> cnt;
-        for(auto p: primes) {
-            cnt[p]++;
-        }
-        std::vector<gaussint<Int>> res = {1};
-        for(auto [p, c]: cnt) {
-            std::vector<gaussint<Int>> nres;
+        // fixed part from p = 2 and p = 3 mod 4, and digit values for p = 1 mod 4
+        gaussint<Int> fixed = 1;
+        std::vector<gaussint<Int>> digits;
+        std::vector<size_t> start = {0};
+        bool possible = true;
+        impl::visit_prime_powers(n, [&](Int p, int c) {
             if(p % 4 == 3) {
-                if(c % 2 == 0) {
-                    auto mul = bpow(gaussint<Int>(p), c / 2);
-                    for(auto p: res) {
-                        nres.push_back(p * mul);
-                    }
-                }
-            } else if(p % 4 == 1) {
-                auto base = two_squares_prime_any(p);
-                for(int i = 0; i <= c; i++) {
-                    auto mul = bpow(base, i) * bpow(conj(base), c - i);
-                    for(auto p: res) {
-                        nres.push_back(p * mul);
-                    }
-                }
+                possible &= c % 2 == 0;
+                fixed *= bpow(gaussint<Int>(p), c / 2);
             } else if(p % 4 == 2) {
-                auto mul = bpow(gaussint<Int>(1, 1), c);
-                for(auto p: res) {
-                    nres.push_back(p * mul);
+                fixed *= bpow(gaussint<Int>(1, 1), c);
+            } else {
+                auto pi = two_squares_prime_any(p);
+                std::vector<gaussint<Int>> pows(c + 1, 1);
+                for(int d = 1; d <= c; d++) {
+                    pows[d] = pows[d - 1] * pi;
                 }
+                for(int d = 0; d <= c; d++) {
+                    digits.push_back(pows[d] * conj(pows[c - d]));
+                }
+                start.push_back(size(digits));
             }
-            res = nres;
+        });
+        if(!possible) {
+            return;
         }
-        std::vector<gaussint<Int>> nres;
-        for(auto p: res) {
-            while(p.real() < 0 || p.imag() < 0) {
-                p *= gaussint<Int>(0, 1);
+        auto rec = [&](auto &&self, size_t j, gaussint<Int> z) -> void {
+            if(j + 1 == size(start)) {
+                while(z.real() < 0 || z.imag() < 0) {
+                    z *= gaussint<Int>(0, 1);
+                }
+                cb(z);
+                if(!z.real() || !z.imag()) {
+                    cb(gaussint<Int>(z.imag(), z.real()));
+                }
+                return;
             }
-            nres.push_back(p);
-            if(!p.real() || !p.imag()) {
-                nres.emplace_back(p.imag(), p.real());
+            for(size_t d = start[j]; d < start[j + 1]; d++) {
+                self(self, j + 1, z * digits[d]);
             }
+        };
+        rec(rec, 0, fixed);
+    }
+
+    template<typename Int>
+    std::vector<gaussint<Int>> two_squares_all(Int n) {
+        std::vector<gaussint<Int>> res;
+        two_squares_visit(n, [&](gaussint<Int> z) {
+            res.push_back(z);
+        });
+        return res;
+    }
+
+    // Number of pairs x, y >= 0 with x^2 + y^2 = n, without listing them
+    template<typename Int>
+    uint64_t two_squares_count(Int n) {
+        if(n == 0) {
+            return 1;
         }
-        return nres;
+        uint64_t res = 1;
+        bool square = true;
+        impl::visit_prime_powers(n, [&](Int p, int c) {
+            square &= c % 2 == 0;
+            if(p % 4 == 3 && c % 2) {
+                res = 0;
+            } else if(p % 4 == 1) {
+                res *= c + 1;
+            }
+        });
+        // x^2 + 0^2 = n is counted twice, as (x, 0) and (0, x)
+        return res ? res + square : 0;
     }
 }
 #endif // CP_ALGO_NUMBER_THEORY_TWO_SQUARES_HPP
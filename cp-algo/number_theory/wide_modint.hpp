@@ -0,0 +1,313 @@
+#ifndef CP_ALGO_NUMBER_THEORY_WIDE_MODINT_HPP
+#define CP_ALGO_NUMBER_THEORY_WIDE_MODINT_HPP
+#include "modint.hpp"
+#include <algorithm>
+#include <concepts>
+#include <iostream>
+#include <compare>
+#include <string>
+#include <array>
+#include <bit>
+namespace cp_algo::math {
+    // Fixed-width unsigned integer of N 64-bit limbs, little-endian,
+    // with wrap-around arithmetic like the built-in unsigned types
+    template<size_t N>
+    struct uint_n {
+        std::array<uint64_t, N> d = {};
+
+        constexpr uint_n() = default;
+        constexpr uint_n(std::integral auto x) {
+            d[0] = uint64_t(x);
+            if constexpr (std::is_signed_v<decltype(x)>) {
+                if(x < 0) {
+                    std::fill(begin(d) + 1, end(d), uint64_t(-1));
+                }
+            }
+        }
+        constexpr uint_n(__uint128_t x) requires (N >= 2) {
+            d[0] = uint64_t(x);
+            d[1] = uint64_t(x >> 64);
+        }
+        template<size_t M>
+        constexpr explicit uint_n(uint_n<M> const& x) {
+            std::copy_n(begin(x.d), std::min(N, M), begin(d));
+        }
+        constexpr explicit operator bool() const {
+            return *this != uint_n();
+        }
+        template<std::integral T>
+        constexpr explicit operator T() const {
+            return T(d[0]);
+        }
+        // Only the lowest limb is set
+        constexpr bool is_small() const {
+            return std::all_of(begin(d) + 1, end(d), [](uint64_t x) {return x == 0;});
+        }
+
+        friend constexpr bool operator == (uint_n const&, uint_n const&) = default;
+        friend constexpr std::strong_ordering operator <=> (uint_n const& a, uint_n const& b) {
+            for(size_t i = N; i-- > 0;) {
+                if(a.d[i] != b.d[i]) {
+                    return a.d[i] <=> b.d[i];
+                }
+            }
+            return std::strong_ordering::equal;
+        }
+
+        constexpr uint_n& operator += (uint_n const& t) {
+            __uint128_t carry = 0;
+            for(size_t i = 0; i < N; i++) {
+                carry += d[i];
+                carry += t.d[i];
+                d[i] = uint64_t(carry);
+                carry >>= 64;
+            }
+            return *this;
+        }
+        constexpr uint_n& operator -= (uint_n const& t) {
+            bool borrow = false;
+            for(size_t i = 0; i < N; i++) {
+                uint64_t x = d[i] - t.d[i] - borrow;
+                borrow = d[i] < t.d[i] || (d[i] == t.d[i] && borrow);
+                d[i] = x;
+            }
+            return *this;
+        }
+        constexpr uint_n& operator *= (uint_n const& t) {
+            return *this = uint_n(mul_wide(*this, t));
+        }
+        constexpr uint_n& operator <<= (size_t s) {
+            size_t w = s / 64, b = s % 64;
+            for(size_t i = N; i-- > 0;) {
+                uint64_t hi = i >= w ? d[i - w] << b : 0;
+                uint64_t lo = b && i >= w + 1 ? d[i - w - 1] >> (64 - b) : 0;
+                d[i] = hi | lo;
+            }
+            return *this;
+        }
+        constexpr uint_n& operator >>= (size_t s) {
+            size_t w = s / 64, b = s % 64;
+            for(size_t i = 0; i < N; i++) {
+                uint64_t lo = i + w < N ? d[i + w] >> b : 0;
+                uint64_t hi = b && i + w + 1 < N ? d[i + w + 1] << (64 - b) : 0;
+                d[i] = hi | lo;
+            }
+            return *this;
+        }
+        constexpr uint_n& operator /= (uint_n const& t) {return *this = divmod(*this, t)[0];}
+        constexpr uint_n& operator %= (uint_n const& t) {return *this = divmod(*this, t)[1];}
+        constexpr uint_n operator - () const {return uint_n() -= *this;}
+
+        friend constexpr uint_n operator + (uint_n a, uint_n const& b) {return a += b;}
+        friend constexpr uint_n operator - (uint_n a, uint_n const& b) {return a -= b;}
+        friend constexpr uint_n operator * (uint_n a, uint_n const& b) {return a *= b;}
+        friend constexpr uint_n operator / (uint_n a, uint_n const& b) {return a /= b;}
+        friend constexpr uint_n operator % (uint_n a, uint_n const& b) {return a %= b;}
+        friend constexpr uint_n operator << (uint_n a, size_t s) {return a <<= s;}
+        friend constexpr uint_n operator >> (uint_n a, size_t s) {return a >>= s;}
+
+        // {a / b, a % b}, limb by limb if b fits into a single limb,
+        // bit by bit otherwise
+        friend constexpr std::array<uint_n, 2> divmod(uint_n const& a, uint_n const& b) {
+            assert(b != uint_n());
+            uint_n q, r;
+            if(b.is_small()) {
+                __uint128_t rem = 0;
+                for(size_t i = N; i-- > 0;) {
+                    rem = rem << 64 | a.d[i];
+                    q.d[i] = uint64_t(rem / b.d[0]);
+                    rem %= b.d[0];
+                }
+                r.d[0] = uint64_t(rem);
+                return {q, r};
+            }
+            // cp_algo::bit_width would hide the friend from ADL
+            using std::bit_width;
+            for(size_t i = bit_width(a); i-- > 0;) {
+                bool carry = r.d[N - 1] >> 63;
+                r <<= 1;
+                r.d[0] |= a.d[i / 64] >> (i % 64) & 1;
+                if(carry || r >= b) {
+                    r -= b;
+                    q.d[i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+            return {q, r};
+        }
+        friend constexpr uint_n<2 * N> mul_wide(uint_n const& a, uint_n const& b) {
+            uint_n<2 * N> res;
+            for(size_t i = 0; i < N; i++) {
+                __uint128_t carry = 0;
+                for(size_t j = 0; j < N; j++) {
+                    carry += __uint128_t(a.d[i]) * b.d[j] + res.d[i + j];
+                    res.d[i + j] = uint64_t(carry);
+                    carry >>= 64;
+                }
+                res.d[i + N] = uint64_t(carry);
+            }
+            return res;
+        }
+        friend constexpr size_t countr_zero(uint_n const& x) {
+            for(size_t i = 0; i < N; i++) {
+                if(x.d[i]) {
+                    return 64 * i + std::countr_zero(x.d[i]);
+                }
+            }
+            return 64 * N;
+        }
+        friend constexpr size_t bit_width(uint_n const& x) {
+            for(size_t i = N; i-- > 0;) {
+                if(x.d[i]) {
+                    return 64 * i + std::bit_width(x.d[i]);
+                }
+            }
+            return 0;
+        }
+        // Binary gcd, no divisions needed
+        friend constexpr uint_n gcd(uint_n a, uint_n b) {
+            if(!a || !b) {
+                return a + b;
+            }
+            size_t s = std::min(countr_zero(a), countr_zero(b));
+            a >>= countr_zero(a);
+            while(b) {
+                b >>= countr_zero(b);
+                if(a > b) {
+                    std::swap(a, b);
+                }
+                b -= a;
+            }
+            return a << s;
+        }
+
+        friend decltype(std::cout)& operator << (decltype(std::cout) &out, uint_n x) {
+            std::string res;
+            do {
+                auto [q, r] = divmod(x, uint_n(10));
+                res += char('0' + r.d[0]);
+                x = q;
+            } while(x);
+            std::ranges::reverse(res);
+            return out << res;
+        }
+        friend decltype(std::cin)& operator >> (decltype(std::cin) &in, uint_n &x) {
+            std::string s;
+            in >> s;
+            x = 0;
+            for(char c: s) {
+                x = x * 10 + uint64_t(c - '0');
+            }
+            return in;
+        }
+    };
+
+    template<size_t N>
+    struct modint_ints<uint_n<N>> {
+        using UInt = uint_n<N>;
+        using Int2 = uint_n<2 * N>;
+        using UInt2 = uint_n<2 * N>;
+    };
+
+    // Runtime modulus of up to 64N - 1 bits in Montgomery form,
+    // multiplied with CIOS. The modulus must be odd.
+    // Values are kept exactly in [0, m).
+    template<size_t N>
+    struct wide_modint: modint_base<wide_modint<N>, uint_n<N>> {
+        using Base = modint_base<wide_modint<N>, uint_n<N>>;
+        using UInt = uint_n<N>;
+
+        wide_modint() = default;
+        wide_modint(std::integral auto x) {
+            if constexpr (std::is_signed_v<decltype(x)>) {
+                if(x < 0) {
+                    *this = -wide_modint(-UInt(x));
+                    return;
+                }
+            }
+            setr(UInt(x) % mod());
+        }
+        wide_modint(UInt const& x) {
+            setr(x % mod());
+        }
+
+        // a * b / 2^{64N} mod m
+        static UInt m_reduce(UInt const& a, UInt const& b) {
+            std::array<uint64_t, N + 2> t = {};
+            for(size_t i = 0; i < N; i++) {
+                __uint128_t carry = 0;
+                for(size_t j = 0; j < N; j++) {
+                    carry += __uint128_t(a.d[j]) * b.d[i] + t[j];
+                    t[j] = uint64_t(carry);
+                    carry >>= 64;
+                }
+                carry += t[N];
+                t[N] = uint64_t(carry);
+                t[N + 1] = uint64_t(carry >> 64);
+                uint64_t q = t[0] * im;
+                carry = (__uint128_t(q) * m.d[0] + t[0]) >> 64;
+                for(size_t j = 1; j < N; j++) {
+                    carry += __uint128_t(q) * m.d[j] + t[j];
+                    t[j - 1] = uint64_t(carry);
+                    carry >>= 64;
+                }
+                carry += t[N];
+                t[N - 1] = uint64_t(carry);
+                t[N] = t[N + 1] + uint64_t(carry >> 64);
+            }
+            UInt res;
+            std::copy_n(begin(t), N, begin(res.d));
+            if(t[N] || res >= m) {
+                res -= m;
+            }
+            return res;
+        }
+        wide_modint& operator *= (const wide_modint &t) {
+            Base::r = m_reduce(Base::r, t.r);
+            return *this;
+        }
+        void setr(UInt const& rr) {
+            Base::r = m_reduce(rr, r2);
+        }
+        UInt getr() const {
+            return m_reduce(Base::r, UInt(1));
+        }
+        static UInt mod() {return m;}
+        static UInt remod() {return m;}
+        static void switch_mod(UInt const& nm) {
+            assert(nm.d[0] % 2 && !(nm.d[N - 1] >> 63));
+            m = nm;
+            im = inv2(-m.d[0]);
+            // 2^{128N} mod m by doubling
+            r2 = UInt(1) % m;
+            for(size_t i = 0; i < 128 * N; i++) {
+                r2 <<= 1;
+                if(r2 >= m) {
+                    r2 -= m;
+                }
+            }
+        }
+        auto static with_mod(UInt const& tmp, auto callback) {
+            struct scoped {
+                UInt prev = mod();
+                ~scoped() {switch_mod(prev);}
+            } _;
+            switch_mod(tmp);
+            return callback();
+        }
+    private:
+        static thread_local UInt m, r2;
+        static thread_local uint64_t im;
+    };
+    template<size_t N>
+    uint_n<N> thread_local wide_modint<N>::m = 1;
+    template<size_t N>
+    uint_n<N> thread_local wide_modint<N>::r2 = 0;
+    template<size_t N>
+    uint64_t thread_local wide_modint<N>::im = 1;
+
+    template<size_t N>
+    struct modint_for<uint_n<N>> {
+        using type = wide_modint<N>;
+    };
+}
+#endif // CP_ALGO_NUMBER_THEORY_WIDE_MODINT_HPP
@@ -2,6 +2,7 @@
 #define CP_ALGO_UTIL_big_alloc_HPP
 
 #include <cstddef>
+#include <bit>
 #include <iostream>
 
 // Single macro to detect POSIX platforms (Linux, Unix, macOS)
@@ -0,0 +1,106 @@
+#ifndef CP_ALGO_UTIL_PARALLEL_HPP
+#define CP_ALGO_UTIL_PARALLEL_HPP
+#include <algorithm>
+#include <functional>
+#include <semaphore>
+#include <cstdlib>
+#include <utility>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <latch>
+#include <mutex>
+namespace cp_algo {
+    // CP_ALGO_THREADS in the environment overrides the hardware default
+    inline size_t num_threads() {
+        static const size_t threads = []() -> size_t {
+            if(auto env = std::getenv("CP_ALGO_THREADS")) {
+                return std::max(1, std::atoi(env));
+            }
+            return std::max(1u, std::thread::hardware_concurrency());
+        }();
+        return threads;
+    }
+    namespace impl {
+        // Threads that sleep between parallel_for calls. A call takes as many
+        // idle workers as it needs and starts new ones when there are not enough,
+        // so all chunks of a call run at once and may wait for each other
+        class thread_pool {
+            struct worker {
+                std::binary_semaphore ready{0};
+                std::function<void()> task;
+                std::latch* done = nullptr;
+                std::jthread thread;
+            };
+            std::mutex lock;
+            std::vector<std::unique_ptr<worker>> workers;
+            std::vector<worker*> idle;
+
+            void loop(worker &w) {
+                while(true) {
+                    w.ready.acquire();
+                    if(!w.task) {
+                        return;
+                    }
+                    w.task();
+                    // The worker is free before the caller can return
+                    auto done = std::exchange(w.done, nullptr);
+                    w.task = nullptr;
+                    {
+                        std::lock_guard guard(lock);
+                        idle.push_back(&w);
+                    }
+                    done->count_down();
+                }
+            }
+        public:
+            static thread_pool& get() {
+                static thread_pool pool;
+                return pool;
+            }
+            // Runs task(t) for 0 < t < k in pool threads and task(0) in this one
+            void run(size_t k, auto &&task) {
+                std::latch done(ptrdiff_t(k - 1));
+                {
+                    std::lock_guard guard(lock);
+                    for(size_t t = 1; t < k; t++) {
+                        if(idle.empty()) {
+                            auto &w = *workers.emplace_back(std::make_unique<worker>());
+                            w.thread = std::jthread([this, &w]() {loop(w);});
+                            idle.push_back(&w);
+                        }
+                        auto w = idle.back();
+                        idle.pop_back();
+                        w->task = [&task, t]() {task(t);};
+                        w->done = &done;
+                        w->ready.release();
+                    }
+                }
+                task(size_t(0));
+                done.wait();
+            }
+            ~thread_pool() {
+                for(auto &w: workers) {
+                    w->ready.release();
+                }
+            }
+        };
+    }
+    // Splits [0, n) into at most `threads` contiguous chunks and runs
+    // callback(t, l, r) for the t-th chunk [l, r), each in its own thread.
+    // Threads are kept in a pool between calls, the first chunk runs
+    // in the calling thread, and it runs inline when there is only one chunk
+    void parallel_for(size_t n, auto &&callback, size_t threads = num_threads()) {
+        threads = std::min(threads, n);
+        if(threads <= 1) {
+            if(n) {
+                callback(size_t(0), size_t(0), n);
+            }
+            return;
+        }
+        impl::thread_pool::get().run(threads, [&callback, n, threads](size_t t) {
+            callback(t, n * t / threads, n * (t + 1) / threads);
+        });
+    }
+}
+#endif // CP_ALGO_UTIL_PARALLEL_HPP
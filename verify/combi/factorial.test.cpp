@@ -0,0 +1,26 @@
+// @brief Factorial
+#define PROBLEM "https://judge.yosupo.jp/problem/factorial"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include <bits/stdc++.h>
+#include "cp-algo/math/factorials.hpp"
+
+using namespace std;
+using namespace cp_algo::math;
+using base = modint<998244353>;
+
+void solve() {
+    uint64_t n;
+    cin >> n;
+    cout << fact_large<base>(n) << "\n";
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    cin >> t;
+    while(t--) {
+        solve();
+    }
+}
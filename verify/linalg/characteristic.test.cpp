@@ -19,8 +19,7 @@ void solve() {
     cin >> n;
     matrix<base> A(n);
     A.read();
-    auto blocks = frobenius_form(A);
-    reduce(begin(blocks), end(blocks), polyn(1), multiplies{}).print();
+    charpoly(A).print();
 }
 
 signed main() {
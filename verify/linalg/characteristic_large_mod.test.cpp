@@ -0,0 +1,61 @@
+// @brief Characteristic Polynomial (modulus above 2^31)
+#define PROBLEM "https://judge.yosupo.jp/problem/characteristic_polynomial"
+#pragma GCC optimize("Ofast,unroll-loops")
+#define CP_ALGO_MAXN 1 << 10
+#include <bits/stdc++.h>
+#include "blazingio/blazingio.min.hpp"
+#include "cp-algo/linalg/frobenius.hpp"
+
+using namespace std;
+using namespace cp_algo::math;
+using namespace cp_algo::linalg;
+
+const int64_t mod = 998244353;
+using base = modint<mod>;
+using polyn = poly_t<base>;
+// Lazy sums don't fit with this modulus, and dot has to reduce often
+using wide = modint<int64_t(2147483659)>;
+
+// Whether p(A) x = 0 for a random x
+bool cayley_hamilton(matrix<wide> const& A, poly_t<wide> const& p) {
+    size_t n = A.n();
+    auto x = matrix<wide>::vec_t::random(n);
+    matrix<wide>::vec_t y(n);
+    for(int i = p.deg(); i >= 0; i--) {
+        y = A.apply(y);
+        for(size_t j = 0; j < n; j++) {
+            y[j] += p[i] * x[j];
+        }
+    }
+    return std::ranges::count(y, wide(0)) == ptrdiff_t(n);
+}
+
+void solve() {
+    size_t n;
+    cin >> n;
+    matrix<base> A(n);
+    A.read();
+    matrix<wide> B(n);
+    for(size_t i = 0; i < n; i++) {
+        for(size_t j = 0; j < n; j++) {
+            B[i][j] = A[i][j].getr();
+        }
+    }
+    auto p = charpoly(B);
+    if(size_t(p.deg()) != n || !cayley_hamilton(B, p)) {
+        cout << -1 << "\n";
+        return;
+    }
+    charpoly(A).print();
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    //cin >> t;
+    while(t--) {
+        solve();
+    }
+}
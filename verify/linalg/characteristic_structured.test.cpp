@@ -0,0 +1,69 @@
+// @brief Characteristic Polynomial (structured)
+#define PROBLEM "https://judge.yosupo.jp/problem/characteristic_polynomial"
+#pragma GCC optimize("Ofast,unroll-loops")
+#define CP_ALGO_MAXN 1 << 10
+#include <bits/stdc++.h>
+#include "blazingio/blazingio.min.hpp"
+#include "cp-algo/linalg/frobenius.hpp"
+#include "cp-algo/random/rng.hpp"
+
+using namespace std;
+using namespace cp_algo::math;
+using namespace cp_algo::linalg;
+using namespace cp_algo::random;
+
+const int64_t mod = 998244353;
+using base = modint<mod>;
+using polyn = poly_t<base>;
+
+// Random 8 x 8 matrix that is upper Hessenberg in columns 0 and 1,
+// with columns 2 and 3 arranged so that hessenberg has nothing
+// to do in column 3, but has to reduce column 4 again
+matrix<base> skipping_block() {
+    matrix<base> R(8);
+    for(size_t i = 0; i < 8; i++) {
+        for(size_t j = 0; j < 8; j++) {
+            if(j > 2 || i <= j + 1) {
+                R[i][j] = rng();
+            }
+        }
+    }
+    R[3][2] = R[4][2] = 1;
+    for(size_t i = 5; i < 8; i++) {
+        R[i][3] = -R[i][4];
+    }
+    R[4][3] = R[3][3] + R[3][4] - R[4][4];
+    return R;
+}
+
+void solve() {
+    size_t n;
+    cin >> n;
+    // A is found as a block of diag(R, A)
+    auto R = skipping_block();
+    matrix<base> B(n + 8);
+    for(size_t i = 0; i < 8; i++) {
+        std::ranges::copy(R[i], begin(B[i]));
+    }
+    for(size_t i = 0; i < n; i++) {
+        for(size_t j = 0; j < n; j++) {
+            cin >> B[i + 8][j + 8];
+        }
+    }
+    polyn charR(base(1));
+    for(auto const& f: frobenius_form(R)) {
+        charR *= f;
+    }
+    (charpoly(B) / charR).print();
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    //cin >> t;
+    while(t--) {
+        solve();
+    }
+}
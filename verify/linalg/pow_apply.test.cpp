@@ -0,0 +1,42 @@
+// @brief Pow of Matrix (apply_pow)
+#define PROBLEM "https://judge.yosupo.jp/problem/pow_of_matrix"
+#pragma GCC optimize("Ofast,unroll-loops")
+#define CP_ALGO_MAXN 256
+#include <bits/stdc++.h>
+#include "blazingio/blazingio.min.hpp"
+#include "cp-algo/linalg/frobenius.hpp"
+
+using namespace std;
+using namespace cp_algo::math;
+using namespace cp_algo::linalg;
+
+const int64_t mod = 998244353;
+using base = modint<mod>;
+using polyn = poly_t<base>;
+
+void solve() {
+    size_t n;
+    uint64_t k;
+    cin >> n >> k;
+    matrix<base> A(n);
+    A.read();
+    // Row i of A^k is e_i A^k, charpoly is shared by all rows
+    auto charp = charpoly(A);
+    matrix<base> res(n);
+    for(size_t i = 0; i < n; i++) {
+        auto row = apply_pow(A, matrix<base>::vec_t::ei(n, i), k, charp);
+        std::ranges::copy(row, begin(res[i]));
+    }
+    res.print();
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    //cin >> t;
+    while(t--) {
+        solve();
+    }
+}
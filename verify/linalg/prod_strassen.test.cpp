@@ -0,0 +1,42 @@
+// @brief Matrix Product (Strassen)
+#define PROBLEM "https://judge.yosupo.jp/problem/matrix_product"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include <bits/stdc++.h>
+#include "blazingio/blazingio.min.hpp"
+#include "cp-algo/linalg/matrix.hpp"
+#include "cp-algo/linalg/strassen.hpp"
+
+using namespace std;
+using namespace cp_algo::linalg;
+using namespace cp_algo::math;
+
+const int64_t mod = 998244353;
+using base = modint<mod>;
+
+void solve() {
+    int n, m, k;
+    cin >> n >> m >> k;
+    matrix<base> a(n, m), b(m, k);
+    a.read();
+    b.read();
+    // A small cutoff makes the recursion go several levels deep
+    matrix<base> c(n, k);
+    strassen<base>(n, m, k, [&](size_t i, size_t j) {
+        return a[i][j];
+    }, [&](size_t i, size_t j) {
+        return b[i][j];
+    }, [&](size_t i, size_t j) -> base& {
+        return c[i][j];
+    }, 16);
+    c.print();
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
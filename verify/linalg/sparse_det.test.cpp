@@ -0,0 +1,33 @@
+// @brief Determinant of Sparse Matrix
+#define PROBLEM "https://judge.yosupo.jp/problem/sparse_matrix_det"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include <bits/stdc++.h>
+#include "blazingio/blazingio.min.hpp"
+#include "cp-algo/linalg/sparse.hpp"
+
+using namespace std;
+using namespace cp_algo::math;
+using namespace cp_algo::linalg;
+
+const int64_t mod = 998244353;
+using base = modint<mod>;
+
+void solve() {
+    size_t n, k;
+    cin >> n >> k;
+    vector<tuple<size_t, size_t, base>> entries(k);
+    for(auto &[a, b, c]: entries) {
+        cin >> a >> b >> c;
+    }
+    cout << sparse_matrix<base>(n, n, entries).det() << "\n";
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
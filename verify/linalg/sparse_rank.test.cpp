@@ -0,0 +1,48 @@
+// @brief Rank of Matrix (sparse)
+#define PROBLEM "https://judge.yosupo.jp/problem/matrix_rank"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include <bits/stdc++.h>
+#include "blazingio/blazingio.min.hpp"
+#include "cp-algo/linalg/sparse.hpp"
+
+using namespace std;
+using namespace cp_algo::math;
+using namespace cp_algo::linalg;
+
+const int64_t mod = 998244353;
+using base = modint<mod>;
+
+void solve() {
+    size_t n, m;
+    cin >> n >> m;
+    // Krylov sequences are taken in the smaller dimension
+    bool transpose = m > n;
+    vector<tuple<size_t, size_t, base>> entries;
+    for(size_t i = 0; i < n; i++) {
+        for(size_t j = 0; j < m; j++) {
+            base x;
+            cin >> x;
+            if(x != base(0)) {
+                if(transpose) {
+                    entries.emplace_back(j, i, x);
+                } else {
+                    entries.emplace_back(i, j, x);
+                }
+            }
+        }
+    }
+    if(transpose) {
+        swap(n, m);
+    }
+    cout << sparse_matrix<base>(n, m, entries).rank() << "\n";
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
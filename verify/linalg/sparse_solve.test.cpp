@@ -0,0 +1,64 @@
+// @brief System of Linear Equations (sparse)
+#define PROBLEM "https://judge.yosupo.jp/problem/system_of_linear_equations"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include <bits/stdc++.h>
+#include "blazingio/blazingio.min.hpp"
+#include "cp-algo/linalg/sparse.hpp"
+
+using namespace std;
+using namespace cp_algo::linalg;
+using namespace cp_algo::math;
+
+const int64_t mod = 998244353;
+using base = modint<mod>;
+
+void solve() {
+    size_t n, m;
+    cin >> n >> m;
+    matrix<base> A(n, m), b(n, 1);
+    A.read();
+    b.read();
+    // Nonsingular square systems have the unique solution found by
+    // sparse_matrix::solve, the others go to the dense solver
+    if(n == m) {
+        vector<tuple<size_t, size_t, base>> entries;
+        for(size_t i = 0; i < n; i++) {
+            for(size_t j = 0; j < n; j++) {
+                if(A[i][j] != base(0)) {
+                    entries.emplace_back(i, j, A[i][j]);
+                }
+            }
+        }
+        sparse_matrix<base> S(n, n, entries);
+        if(S.det() != base(0)) {
+            sparse_matrix<base>::vec_t rhs(n);
+            for(size_t i = 0; i < n; i++) {
+                rhs[i] = b[i][0];
+            }
+            auto x = S.solve(rhs);
+            assert(x);
+            cout << 0 << "\n";
+            x->print();
+            return;
+        }
+    }
+    auto x = A.solve(b);
+    if(!x) {
+        cout << -1 << "\n";
+    } else {
+        auto [sol, basis] = *x;
+        cout << basis.n() << "\n";
+        sol.print();
+        basis.print();
+    }
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
@@ -0,0 +1,24 @@
+// @brief Counting Primes
+#define PROBLEM "https://judge.yosupo.jp/problem/counting_primes"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include "cp-algo/number_theory/prime_sums.hpp"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace cp_algo::math;
+
+void solve() {
+    uint64_t n;
+    cin >> n;
+    cout << count_primes(n) << "\n";
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
@@ -0,0 +1,33 @@
+// @brief Enumerate Primes
+#define PROBLEM "https://judge.yosupo.jp/problem/enumerate_primes"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include "cp-algo/number_theory/sieve.hpp"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace cp_algo::math;
+
+void solve() {
+    uint64_t n, a, b;
+    cin >> n >> a >> b;
+    auto primes = primes_range(0, n + 1);
+    vector<uint64_t> res;
+    for(size_t i = b; i < size(primes); i += a) {
+        res.push_back(primes[i]);
+    }
+    cout << size(primes) << ' ' << size(res) << "\n";
+    for(auto p: res) {
+        cout << p << ' ';
+    }
+    cout << "\n";
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
@@ -10,8 +10,7 @@ using namespace cp_algo::math;
 void solve() {
     int64_t m;
     cin >> m;
-    auto res = to<vector>(factorize(m));
-    ranges::sort(res);
+    auto res = factorize(m);
     cout << size(res) << " ";
     ranges::copy(res, ostream_iterator<int64_t>(cout, " "));
     cout << "\n";
@@ -0,0 +1,25 @@
+// @brief Factorize (batch)
+#define PROBLEM "https://judge.yosupo.jp/problem/factorize"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include "cp-algo/number_theory/factorize.hpp"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace cp_algo::math;
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    size_t t;
+    cin >> t;
+    vector<uint64_t> a(t);
+    for(auto &x: a) {
+        cin >> x;
+    }
+    for(auto const& res: factorize_many(a)) {
+        cout << size(res) << " ";
+        ranges::copy(res, ostream_iterator<uint64_t>(cout, " "));
+        cout << "\n";
+    }
+}
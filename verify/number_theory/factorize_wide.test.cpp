@@ -0,0 +1,65 @@
+// @brief Factorize (uint_n<2>)
+#define PROBLEM "https://judge.yosupo.jp/problem/factorize"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include "cp-algo/number_theory/wide_modint.hpp"
+#include "cp-algo/number_theory/factorize.hpp"
+#include "cp-algo/number_theory/discrete_sqrt.hpp"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace cp_algo::math;
+
+using u128 = uint_n<2>;
+using base = wide_modint<2>;
+
+// Inputs of the problem fit in 64 bits, so wider numbers are checked here
+bool wide_checks() {
+    // 2^89 - 1 is a Mersenne prime
+    u128 p = (u128(1) << 89) - 1;
+    if(!is_prime(p) || is_prime(p - 2)) {
+        return false;
+    }
+    vector<u128> primes = {998244353, 1000000007, 1004535809};
+    auto f = factorize(primes[0] * primes[1] * primes[2]);
+    if(f != primes || factorize(p) != vector{p}) {
+        return false;
+    }
+    return base::with_mod(p, [&]() {
+        for(uint64_t x: {2ULL, 3ULL, 123456789ULL, 998244353ULL << 30}) {
+            base a = u128(x);
+            // Fermat's little theorem
+            if(bpow(a, p - 1) != base(1)) {
+                return false;
+            }
+            auto r = sqrt(a * a);
+            if(!r || *r * *r != a * a) {
+                return false;
+            }
+        }
+        // -1 is not a square for p = 3 mod 4
+        return !sqrt(base(-1));
+    });
+}
+
+void solve() {
+    int64_t m;
+    cin >> m;
+    auto res = factorize(u128(m));
+    cout << size(res) << " ";
+    ranges::copy(res, ostream_iterator<u128>(cout, " "));
+    cout << "\n";
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    if(!wide_checks()) {
+        return 1;
+    }
+    int t = 1;
+    cin >> t;
+    while(t--) {
+        solve();
+    }
+}
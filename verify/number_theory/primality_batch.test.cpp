@@ -0,0 +1,25 @@
+// @brief Primality Test (batch)
+#define PROBLEM "https://judge.yosupo.jp/problem/primality_test"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include "cp-algo/number_theory/primality.hpp"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace cp_algo::math;
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    size_t t;
+    cin >> t;
+    vector<uint64_t> a(t);
+    for(auto &x: a) {
+        cin >> x;
+    }
+    auto res = make_unique<bool[]>(t);
+    is_prime_batch(a, span(res.get(), t));
+    for(size_t i = 0; i < t; i++) {
+        cout << (res[i] ? "Yes" : "No") << "\n";
+    }
+}
@@ -0,0 +1,27 @@
+// @brief Sum of Totient Function
+#define PROBLEM "https://judge.yosupo.jp/problem/sum_of_totient_function"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include "cp-algo/number_theory/prime_sums.hpp"
+#include "cp-algo/number_theory/modint.hpp"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace cp_algo::math;
+const int mod = 998244353;
+using base = modint<mod>;
+
+void solve() {
+    uint64_t n;
+    cin >> n;
+    cout << totient_sum<base>(n) << "\n";
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
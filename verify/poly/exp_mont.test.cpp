@@ -0,0 +1,30 @@
+// @brief Exp of Power Series (Montgomery modint)
+#define PROBLEM "https://judge.yosupo.jp/problem/exp_of_formal_power_series"
+#pragma GCC optimize("Ofast,unroll-loops")
+#include "cp-algo/math/poly.hpp"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace cp_algo::math;
+
+const int mod = 998244353;
+using base = mont_modint<mod>;
+using polyn = poly_t<base>;
+
+void solve() {
+    int n;
+    cin >> n;
+    polyn::Vector a(n);
+    copy_n(istream_iterator<base>(cin), n, begin(a));
+    polyn(a).exp_inplace(n).print(n);
+}
+
+signed main() {
+    //freopen("input.txt", "r", stdin);
+    ios::sync_with_stdio(0);
+    cin.tie(0);
+    int t = 1;
+    while(t--) {
+        solve();
+    }
+}
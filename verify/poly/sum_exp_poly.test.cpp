@@ -3,6 +3,7 @@
 #pragma GCC optimize("Ofast,unroll-loops")
 #define CP_ALGO_MAXN 1 << 24
 #include "cp-algo/math/poly.hpp"
+#include "cp-algo/number_theory/sieve.hpp"
 #include <bits/stdc++.h>
 
 using namespace std;
@@ -28,20 +29,7 @@ void solve() {
     polyn H = num / den;
     base ans = 0;
 
-    vector<base> id(d+1);
-    vector<int> lp(d+1);
-    id[0] = bpow(base(0), d);
-    id[1] = 1;
-    for(int i = 2; i <= d; i++) {
-        if(lp[i] == 0) {
-            id[i] = bpow(base(i), d);
-            for(int j = i; j <= d; j += i) {
-                lp[j] = i;
-            }
-        } else {
-            id[i] = id[lp[i]] * id[i / lp[i]];
-        }
-    }
+    auto id = pow_range<base>(d + 1, d);
 
     for(int i = 0; i <= d; i++) {
         ans += H[i] * id[i];